@@ -0,0 +1,295 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <time.h>
+#include <malloc.h>
+
+#include "bench.h"
+#include "../utils.h"
+
+/* Allocation functions of the C library, our hooks are forwarding to. */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t num, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+/* Configuration items, overridden by benchmarks. */
+typedef struct {
+    const char *key;
+    const char *value;
+} ConfItem;
+
+static ConfItem conf_items[BENCH_MAX_CONF];
+static size_t conf_size;
+
+static int counting;
+static size_t alloc_count;
+static size_t alloc_bytes;
+static int64_t live_bytes;
+static int64_t peak_bytes;
+
+/* Accounts specified allocation, if counting is enabled. */
+static void
+account_alloc(void *ptr, size_t size, size_t old_usable) {
+
+    if (!ptr || !__atomic_load_n(&counting, __ATOMIC_RELAXED))
+        return;
+
+    __atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, size, __ATOMIC_RELAXED);
+
+    int64_t live = __atomic_add_fetch(&live_bytes,
+            (int64_t) malloc_usable_size(ptr) - (int64_t) old_usable, __ATOMIC_RELAXED);
+
+    int64_t peak = __atomic_load_n(&peak_bytes, __ATOMIC_RELAXED);
+    while (live > peak) {
+        if (__atomic_compare_exchange_n(&peak_bytes, &peak, live, 0,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+    }
+}
+
+/* Accounts specified deallocation, if counting is enabled. */
+static void
+account_free(void *ptr) {
+
+    if (!ptr || !__atomic_load_n(&counting, __ATOMIC_RELAXED))
+        return;
+
+    __atomic_sub_fetch(&live_bytes, (int64_t) malloc_usable_size(ptr), __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size) {
+
+    void *ptr = __libc_malloc(size);
+    account_alloc(ptr, size, 0);
+    return ptr;
+}
+
+void *calloc(size_t num, size_t size) {
+
+    void *ptr = __libc_calloc(num, size);
+    account_alloc(ptr, num * size, 0);
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+
+    size_t old_usable = ptr ? malloc_usable_size(ptr) : 0;
+    void *new_ptr = __libc_realloc(ptr, size);
+    account_alloc(new_ptr, size, old_usable);
+    return new_ptr;
+}
+
+void free(void *ptr) {
+
+    account_free(ptr);
+    __libc_free(ptr);
+}
+
+static void
+stub_lock(void) {}
+
+static const char *
+find_conf(const char *key) {
+
+    for (size_t i = 0; i < conf_size; ++i) {
+        if (strcmp(conf_items[i].key, key) == 0)
+            return conf_items[i].value;
+    }
+    return NULL;
+}
+
+static const char *
+stub_conf_get_str_fast(const char *key, const char *def) {
+
+    const char *value = find_conf(key);
+    return value ? value : def;
+}
+
+static int
+stub_conf_get_int(const char *key, int def) {
+
+    const char *value = find_conf(key);
+    return value ? atoi(value) : def;
+}
+
+static void
+stub_conf_set_str(const char *key, const char *value) {}
+
+static const char *
+stub_junk_detect_charset(const char *str) {
+    return NULL;
+}
+
+static void
+stub_fabort(DB_FILE *stream) {}
+
+/* Stub deadbeef API. Only functions used by the benchmarked code are set. */
+static DB_functions_t stub_api = {
+    .pl_lock = stub_lock,
+    .pl_unlock = stub_lock,
+    .conf_lock = stub_lock,
+    .conf_unlock = stub_lock,
+    .conf_get_str_fast = stub_conf_get_str_fast,
+    .conf_get_int = stub_conf_get_int,
+    .conf_set_str = stub_conf_set_str,
+    .junk_detect_charset = stub_junk_detect_charset,
+    .fabort = stub_fabort,
+};
+
+/* Installs stub deadbeef API, so plug-in code can run without the player. */
+void bench_init(void) {
+
+    deadbeef = &stub_api;
+    xmlInitParser();
+}
+
+/* Overrides value of the plug-in's configuration item. */
+int bench_set_conf(const char *key, const char *value) {
+
+    for (size_t i = 0; i < conf_size; ++i) {
+        if (strcmp(conf_items[i].key, key) == 0) {
+            if (value) {
+                conf_items[i].value = value;
+            } else {
+                conf_items[i] = conf_items[--conf_size];
+            }
+            return 0;
+        }
+    }
+    if (!value)
+        return 0;
+
+    if (conf_size == BENCH_MAX_CONF)
+        return -1;
+
+    conf_items[conf_size].key = key;
+    conf_items[conf_size].value = value;
+    ++conf_size;
+    return 0;
+}
+
+/* Returns monotonic clock value in nanoseconds. */
+uint64_t bench_now_ns(void) {
+
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Starts counting memory allocations. */
+void bench_alloc_start(void) {
+
+    __atomic_store_n(&alloc_count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&alloc_bytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&live_bytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&peak_bytes, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&counting, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Stops counting memory allocations and returns collected statistics. */
+void bench_alloc_stop(AllocStats *stats) {
+
+    __atomic_store_n(&counting, 0, __ATOMIC_SEQ_CST);
+
+    stats->count = __atomic_load_n(&alloc_count, __ATOMIC_RELAXED);
+    stats->bytes = __atomic_load_n(&alloc_bytes, __ATOMIC_RELAXED);
+    stats->peak = __atomic_load_n(&peak_bytes, __ATOMIC_RELAXED);
+}
+
+/* Runs specified benchmark over all corpus items and prints the results. */
+void bench_run(const char *name, BenchFunc func, void *ctx, size_t items, size_t bytes) {
+
+    if (items == 0)
+        return;
+
+    /* Warming up caches and lazily initialized library state. */
+    for (size_t i = 0; i < items; ++i)
+        func(i, ctx);
+
+    /* Allocations are counted during a separate pass, so the
+     * hooks don't affect the timings. */
+    AllocStats stats = {0};
+    bench_alloc_start();
+    for (size_t i = 0; i < items; ++i)
+        func(i, ctx);
+    bench_alloc_stop(&stats);
+
+    size_t passes = 0;
+    uint64_t elapsed = 0;
+    uint64_t begin = bench_now_ns();
+    do {
+        for (size_t i = 0; i < items; ++i)
+            func(i, ctx);
+
+        ++passes;
+        elapsed = bench_now_ns() - begin;
+    } while (elapsed < BENCH_MIN_NS);
+
+    double ops = (double) passes * items;
+    printf("%-32s %12.1f ns/op %10.2f allocs/op %12.1f B/op %10zu B peak",
+           name, elapsed / ops, (double) stats.count / items,
+           (double) stats.bytes / items, stats.peak);
+
+    if (bytes > 0) {
+        double mbs = ((double) bytes * passes / (1024 * 1024)) / (elapsed / 1e9);
+        printf(" %10.2f MB/s", mbs);
+    }
+    printf("\n");
+}
+
+/* Loads non-empty lines of the specified text file. */
+int bench_load_lines(const char *file, char ***lines, size_t *size) {
+
+    char *content = NULL;
+    if (load_txt_file(file, &content) == -1)
+        return -1;
+
+    size_t num = 0;
+    for (char *ch = content; *ch; ++ch) {
+        if (*ch == '\n')
+            ++num;
+    }
+
+    *lines = calloc(num + 1, sizeof(char*));
+    if (!*lines) {
+        free(content);
+        return -1;
+    }
+
+    *size = 0;
+    char *save = NULL;
+    for (char *line = strtok_r(content, "\n", &save); line;
+         line = strtok_r(NULL, "\n", &save))
+    {
+        (*lines)[(*size)++] = strdup(line);
+    }
+    free(content);
+    return 0;
+}
+
+/* Frees lines loaded by bench_load_lines. */
+void bench_free_lines(char **lines, size_t size) {
+
+    for (size_t i = 0; i < size; ++i)
+        free(lines[i]);
+
+    free(lines);
+}
@@ -0,0 +1,70 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_BENCH_HEADER
+#define INFOBAR_BENCH_HEADER
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Minimal amount of time each benchmark is measured for. */
+#define BENCH_MIN_NS 200000000ULL
+
+/* Maximum number of overridden configuration items. */
+#define BENCH_MAX_CONF 32
+
+/* Allocation statistics collected by the malloc hooks. */
+typedef struct {
+    size_t count;
+    size_t bytes;
+    size_t peak;
+} AllocStats;
+
+/* Benchmark body, processes the i-th item of the corpus. */
+typedef void (*BenchFunc)(size_t i, void *ctx);
+
+/* Installs stub deadbeef API, so plug-in code can run without the player. */
+void bench_init(void);
+
+/* Overrides value of the plug-in's configuration item, NULL value restores
+ * the default one. Key and value should stay valid while they're used. */
+int bench_set_conf(const char *key, const char *value);
+
+/* Returns monotonic clock value in nanoseconds. */
+uint64_t bench_now_ns(void);
+
+/* Starts counting memory allocations. */
+void bench_alloc_start(void);
+
+/* Stops counting memory allocations and returns collected statistics. */
+void bench_alloc_stop(AllocStats *stats);
+
+/* Runs specified benchmark over all corpus items and prints the results.
+ * If bytes is not 0, it's treated as the size of the whole corpus and
+ * throughput is reported as well. */
+void bench_run(const char *name, BenchFunc func, void *ctx, size_t items, size_t bytes);
+
+/* Loads non-empty lines of the specified text file. */
+int bench_load_lines(const char *file, char ***lines, size_t *size);
+
+/* Frees lines loaded by bench_load_lines. */
+void bench_free_lines(char **lines, size_t size);
+
+#endif
@@ -0,0 +1,778 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/* End-to-end latency harness. Loads the plug-in against a stub deadbeef
+ * API and a stub UI, redirects all network requests to the local fake
+ * HTTP server and measures time from the song start till the content
+ * is delivered to the views. */
+
+#include <ftw.h>
+#include <time.h>
+#include <utime.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "bench.h"
+#include "httpd.h"
+#include "../infobar.h"
+
+/* Maximum time to wait for the content of a single track. */
+#define WAIT_TIMEOUT_MS 15000
+#define MAX_HDR_SIZE 8192
+#define LOADING "Loading..."
+
+#if GTK_CHECK_VERSION(3, 0, 0)
+DB_plugin_t *ddb_infobar_gtk3_load(DB_functions_t *ddb);
+#define plugin_load ddb_infobar_gtk3_load
+#else
+DB_plugin_t *ddb_infobar_gtk2_load(DB_functions_t *ddb);
+#define plugin_load ddb_infobar_gtk2_load
+#endif
+
+typedef enum {
+    LYR_VIEW = 0,
+    BIO_VIEW = 1,
+    SIM_VIEW = 2,
+    VIEWS_NUM = 3,
+} ViewType;
+
+static const char *view_names[] = { "lyrics", "biography", "similar" };
+
+/* Stub playlist item. */
+typedef struct {
+    DB_playItem_t item;
+    char *artist;
+    char *title;
+    char *album;
+    int stream;
+} Track;
+
+/* Stub network stream, connected to the fake HTTP server. Like
+ * the player's HTTP streams, it connects on the first read. */
+typedef struct {
+    DB_FILE file;
+    int fd;
+    int aborted;
+    char *url;
+} HttpFile;
+
+typedef struct {
+    void (*fn)(void *ctx);
+    void *ctx;
+} ThreadArg;
+
+/* Latency samples of a single view, in milliseconds. */
+typedef struct {
+    double *values;
+    size_t size;
+    size_t found;
+    size_t timeouts;
+} Samples;
+
+static int httpd_port;
+static int show_stats;
+static pthread_mutex_t play_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t play_cond = PTHREAD_COND_INITIALIZER;
+static Track *playing;
+static uint64_t done_ns[VIEWS_NUM];
+static int found[VIEWS_NUM];
+
+/* Views shown to the user, as the bit mask. */
+static int visible_views = (1 << VIEWS_NUM) - 1;
+
+static ddb_gtkui_widget_t *(*create_widget)(void);
+static ddb_gtkui_t stub_gtkui;
+
+/* Infobar widget, never created by the stub UI. */
+GtkWidget *infobar;
+
+/* Stores the moment, when the content for the playing track was delivered. */
+static void
+content_delivered(ViewType view, const char *title, int has_content) {
+
+    pthread_mutex_lock(&play_mutex);
+    if (playing && (!title || strcmp(title, playing->title) == 0) && done_ns[view] == 0) {
+        done_ns[view] = bench_now_ns();
+        found[view] = has_content;
+        pthread_cond_broadcast(&play_cond);
+    }
+    pthread_mutex_unlock(&play_mutex);
+}
+
+/* Stub UI, the plug-in's views just report delivered content. */
+void create_infobar(void) {}
+
+void infobar_config_changed(void) {}
+
+void infobar_init(struct ddb_gtkui_widget_s *widget) {}
+
+void infobar_destroy(struct ddb_gtkui_widget_s *widget) {}
+
+void infobar_bio_image_size(int *width, int *height) {
+
+    *width = BIO_IMAGE_HEIGHT;
+    *height = BIO_IMAGE_HEIGHT;
+}
+
+gboolean infobar_view_visible(InfobarView view) {
+    return view != VIEW_NONE && (__atomic_load_n(&visible_views, __ATOMIC_RELAXED) & (1 << view));
+}
+
+void update_lyrics_view(const char *lyr_txt, const char *artist, const char *title) {
+
+    if (lyr_txt && strcmp(lyr_txt, LOADING) == 0)
+        return;
+
+    content_delivered(LYR_VIEW, title, lyr_txt != NULL);
+}
+
+void update_bio_view(const char *bio_txt, GdkPixbuf *img) {
+
+    if (bio_txt && strcmp(bio_txt, LOADING) == 0)
+        return;
+
+    content_delivered(BIO_VIEW, NULL, bio_txt != NULL);
+}
+
+void update_similar_view(SimilarInfo *similar, size_t size) {
+
+    if (size == 1 && similar[0].name && strcmp(similar[0].name, LOADING) == 0)
+        return;
+
+    content_delivered(SIM_VIEW, NULL, similar != NULL);
+}
+
+/* The plug-in posts updates of the views to the main loop,
+ * so it's run on its own thread, as by the player's GUI. */
+static void *
+run_main_loop(void *data) {
+
+    g_main_loop_run((GMainLoop*) data);
+    return NULL;
+}
+
+static void
+stub_w_reg_widget(const char *title, uint32_t flags, ddb_gtkui_widget_t *(*create_func)(void), ...) {
+    create_widget = create_func;
+}
+
+static void
+stub_w_unreg_widget(const char *type) {}
+
+static void
+stub_w_override_signals(GtkWidget *widget, gpointer user_data) {}
+
+static DB_plugin_t *
+stub_plug_get_for_id(const char *id) {
+    return strcmp(id, DDB_GTKUI_PLUGIN_ID) == 0 ? (DB_plugin_t*) &stub_gtkui : NULL;
+}
+
+static const char *
+stub_pl_find_meta(DB_playItem_t *it, const char *key) {
+
+    Track *track = (Track*) it;
+    if (strcmp(key, "artist") == 0)
+        return track->artist;
+    if (strcmp(key, "title") == 0)
+        return track->title;
+    if (strcmp(key, "album") == 0)
+        return track->album;
+    return NULL;
+}
+
+static float
+stub_pl_get_item_duration(DB_playItem_t *it) {
+    return ((Track*) it)->stream ? 0.0 : 240.0;
+}
+
+static void
+stub_pl_item_ref(DB_playItem_t *it) {}
+
+static DB_playItem_t *
+stub_streamer_get_playing_track(void) {
+
+    pthread_mutex_lock(&play_mutex);
+    DB_playItem_t *track = playing ? &playing->item : NULL;
+    pthread_mutex_unlock(&play_mutex);
+    return track;
+}
+
+static void *
+thread_entry(void *ctx) {
+
+    ThreadArg arg = *(ThreadArg*) ctx;
+    free(ctx);
+    arg.fn(arg.ctx);
+    return NULL;
+}
+
+static intptr_t
+stub_thread_start(void (*fn)(void *ctx), void *ctx) {
+
+    ThreadArg *arg = malloc(sizeof(ThreadArg));
+    if (!arg)
+        return 0;
+
+    arg->fn = fn;
+    arg->ctx = ctx;
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, thread_entry, arg) != 0) {
+        free(arg);
+        return 0;
+    }
+    return (intptr_t) tid;
+}
+
+static int
+stub_thread_detach(intptr_t tid) {
+    return pthread_detach((pthread_t) tid);
+}
+
+/* Connects to the fake HTTP server instead of the real host and
+ * requests specified URL. Returns -1 if the server didn't answer with 200. */
+static int
+http_connect(HttpFile *file) {
+
+    const char *host = file->url + 7;
+    const char *path = strchr(host, '/');
+    if (!path)
+        path = "/";
+
+    int host_len = strcspn(host, ":/");
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1)
+        return -1;
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(httpd_port);
+
+    char *req = NULL;
+    if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0 ||
+        asprintf(&req, "GET %s HTTP/1.0\r\nHost: %.*s\r\nUser-Agent: deadbeef\r\n\r\n",
+                 path, host_len, host) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+
+    if (send(fd, req, strlen(req), MSG_NOSIGNAL) != (ssize_t) strlen(req)) {
+        free(req);
+        close(fd);
+        return -1;
+    }
+    free(req);
+
+    /* Publishing the socket, so the stream can be aborted while waiting. */
+    pthread_mutex_lock(&play_mutex);
+    file->fd = fd;
+    int aborted = file->aborted;
+    pthread_mutex_unlock(&play_mutex);
+    if (aborted)
+        return -1;
+
+    /* Reading headers one byte at a time, so the body stays in the socket. */
+    char hdr[MAX_HDR_SIZE + 1] = {0};
+    size_t len = 0;
+    while (len < MAX_HDR_SIZE && !strstr(hdr, "\r\n\r\n")) {
+        if (recv(fd, hdr + len, 1, 0) != 1)
+            break;
+        ++len;
+    }
+
+    int status = 0;
+    if (sscanf(hdr, "HTTP/%*s %d", &status) != 1 || status != 200)
+        return -1;
+    return 0;
+}
+
+static DB_FILE *
+stub_fopen(const char *url) {
+
+    if (strncmp(url, "http://", 7) != 0)
+        return NULL;
+
+    HttpFile *file = calloc(1, sizeof(HttpFile));
+    if (!file)
+        return NULL;
+
+    file->fd = -1;
+    file->url = strdup(url);
+    return &file->file;
+}
+
+static size_t
+stub_fread(void *ptr, size_t size, size_t nmemb, DB_FILE *stream) {
+
+    HttpFile *file = (HttpFile*) stream;
+    if (file->aborted)
+        return 0;
+
+    if (file->fd == -1 && http_connect(file) == -1) {
+        file->aborted = 1;
+        return 0;
+    }
+
+    size_t total = size * nmemb;
+    size_t len = 0;
+
+    while (len < total && !file->aborted) {
+        ssize_t got = recv(file->fd, (char*) ptr + len, total - len, 0);
+        if (got <= 0)
+            break;
+        len += got;
+    }
+    return len / size;
+}
+
+/* Interrupts blocking read of the stream. */
+static void
+stub_fabort(DB_FILE *stream) {
+
+    HttpFile *file = (HttpFile*) stream;
+
+    pthread_mutex_lock(&play_mutex);
+    file->aborted = 1;
+    if (file->fd != -1)
+        shutdown(file->fd, SHUT_RDWR);
+    pthread_mutex_unlock(&play_mutex);
+}
+
+static void
+stub_fclose(DB_FILE *stream) {
+
+    HttpFile *file = (HttpFile*) stream;
+    if (file->fd != -1)
+        close(file->fd);
+    free(file->url);
+    free(file);
+}
+
+/* Extends bench stub API with the functions used by the fetch workers. */
+static void
+init_stub_api(void) {
+
+    bench_init();
+
+    deadbeef->pl_find_meta = stub_pl_find_meta;
+    deadbeef->pl_get_item_duration = stub_pl_get_item_duration;
+    deadbeef->pl_item_ref = stub_pl_item_ref;
+    deadbeef->pl_item_unref = stub_pl_item_ref;
+    deadbeef->streamer_get_playing_track = stub_streamer_get_playing_track;
+    deadbeef->thread_start = stub_thread_start;
+    deadbeef->thread_detach = stub_thread_detach;
+    deadbeef->fopen = stub_fopen;
+    deadbeef->fread = stub_fread;
+    deadbeef->fabort = stub_fabort;
+    deadbeef->fclose = stub_fclose;
+    deadbeef->plug_get_for_id = stub_plug_get_for_id;
+
+    stub_gtkui.w_reg_widget = stub_w_reg_widget;
+    stub_gtkui.w_unreg_widget = stub_w_unreg_widget;
+    stub_gtkui.w_override_signals = stub_w_override_signals;
+}
+
+/* Makes specified track the playing one and notifies the plug-in. */
+static void
+start_track(ddb_gtkui_widget_t *widget, Track *track) {
+
+    pthread_mutex_lock(&play_mutex);
+    playing = track;
+    for (int i = 0; i < VIEWS_NUM; ++i) {
+        done_ns[i] = 0;
+        found[i] = 0;
+    }
+    pthread_mutex_unlock(&play_mutex);
+
+    ddb_event_track_t ev = {0};
+    ev.track = &track->item;
+    widget->message(widget, DB_EV_SONGSTARTED, (uintptr_t) &ev, 0, 0);
+}
+
+/* Waits until all views got the content of the playing track
+ * and stores latency samples. */
+static void
+wait_track(uint64_t started, Samples *samples) {
+
+    struct timespec deadline = {0};
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += WAIT_TIMEOUT_MS / 1000;
+
+    pthread_mutex_lock(&play_mutex);
+    for (;;) {
+        int done = 0;
+        /* Hidden views aren't waited for. */
+        for (int i = 0; i < VIEWS_NUM; ++i) {
+            if (done_ns[i] != 0 || !(visible_views & (1 << i)))
+                ++done;
+        }
+        if (done == VIEWS_NUM ||
+            pthread_cond_timedwait(&play_cond, &play_mutex, &deadline) != 0)
+            break;
+    }
+
+    for (int i = 0; i < VIEWS_NUM; ++i) {
+        if (!(visible_views & (1 << i)))
+            continue;
+
+        if (done_ns[i] == 0) {
+            ++samples[i].timeouts;
+            continue;
+        }
+        samples[i].values[samples[i].size++] = (done_ns[i] - started) / 1e6;
+        if (found[i])
+            ++samples[i].found;
+    }
+    playing = NULL;
+    pthread_mutex_unlock(&play_mutex);
+
+    /* Letting workers of the previous track finish. */
+    usleep(20000);
+}
+
+/* Plays the tracks as songs of the single radio stream. Station updates
+ * track info several times per song, and every second song is by the
+ * same artist as the previous one. Only the number of requests is
+ * measured, as views aren't updated for unchanged content. */
+static void
+run_stream_scenario(const char *name, ddb_gtkui_widget_t *widget, Track *tracks,
+                    size_t tracks_num, int updates) {
+
+    Track stream = { .stream = 1 };
+    stream.artist = tracks[0].artist;
+    stream.title = tracks[0].title;
+    stream.album = tracks[0].album;
+    start_track(widget, &stream);
+
+    httpd_reset_requests();
+    for (size_t i = 0; i < tracks_num; ++i) {
+
+        pthread_mutex_lock(&play_mutex);
+        stream.artist = tracks[i & ~(size_t) 1].artist;
+        stream.title = tracks[i].title;
+        stream.album = tracks[i].album;
+        pthread_mutex_unlock(&play_mutex);
+
+        ddb_event_track_t ev = {0};
+        ev.track = &stream.item;
+        for (int j = 0; j < updates; ++j) {
+            widget->message(widget, DB_EV_TRACKINFOCHANGED, (uintptr_t) &ev, 0, 0);
+            usleep(50000);
+        }
+        /* Letting the fetches finish before the next song. */
+        usleep(500000);
+    }
+    printf("%s: %zu songs, %.1f requests/song\n", name, tracks_num,
+           (double) httpd_requests() / tracks_num);
+
+    pthread_mutex_lock(&play_mutex);
+    playing = NULL;
+    pthread_mutex_unlock(&play_mutex);
+    sleep(1);
+}
+
+static int
+cmp_double(const void *a, const void *b) {
+
+    double x = *(const double*) a, y = *(const double*) b;
+    return x < y ? -1 : x > y;
+}
+
+/* Returns specified percentile of the sorted samples. */
+static double
+percentile(const Samples *samples, double pct) {
+
+    if (samples->size == 0)
+        return 0.0;
+
+    size_t idx = (size_t) (pct / 100.0 * (samples->size - 1) + 0.5);
+    return samples->values[idx];
+}
+
+static void
+print_samples(const char *scenario, Samples *samples, size_t tracks_num) {
+
+    size_t reqs = httpd_requests();
+    size_t conns = httpd_connections();
+    size_t not_modified = httpd_not_modified();
+    printf("%s: %zu tracks, %.1f requests/track, %.1f connections/track, %zu not modified\n",
+           scenario, tracks_num, (double) reqs / tracks_num, (double) conns / tracks_num,
+           not_modified);
+
+    for (int i = 0; i < VIEWS_NUM; ++i) {
+        Samples *s = &samples[i];
+        qsort(s->values, s->size, sizeof(double), cmp_double);
+        printf("  %-10s p50 %8.1f ms  p90 %8.1f ms  p99 %8.1f ms  max %8.1f ms"
+               "  found %zu/%zu  timeouts %zu\n", view_names[i],
+               percentile(s, 50), percentile(s, 90), percentile(s, 99),
+               percentile(s, 100), s->found, s->size, s->timeouts);
+        s->size = s->found = s->timeouts = 0;
+    }
+}
+
+static int
+remove_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    return remove(path);
+}
+
+/* Makes cache entry two days old. */
+static int
+age_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+
+    struct utimbuf times = { st->st_atime, time(NULL) - 48 * 60 * 60 };
+    utime(path, &times);
+    return 0;
+}
+
+/* Points plug-in's cache to the new empty directory. */
+static int
+reset_cache(char *cache_dir) {
+
+    if (cache_dir[0])
+        nftw(cache_dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+
+    strcpy(cache_dir, "/tmp/infobar-e2e-XXXXXX");
+    if (!mkdtemp(cache_dir))
+        return -1;
+
+    return setenv("XDG_CACHE_HOME", cache_dir, 1);
+}
+
+/* Plays all tracks one by one, waiting for the content of each of them.
+ * If skips isn't 0, that number of other tracks is started before each
+ * measured one, with skip_ms delay between them. Skipped tracks are never
+ * measured, so they can't warm up the cache for the measured ones. */
+static void
+run_scenario(const char *name, ddb_gtkui_widget_t *widget, Track *tracks,
+             size_t tracks_num, int skips, int skip_ms, Samples *samples) {
+
+    size_t skipped_num = tracks_num * skips;
+    Track *skipped = calloc(skipped_num, sizeof(Track));
+    for (size_t i = 0; i < skipped_num; ++i) {
+        Track *src = &tracks[i % tracks_num];
+        asprintf(&skipped[i].artist, "%s (skipped %zu)", src->artist, i);
+        asprintf(&skipped[i].title, "%s (skipped %zu)", src->title, i);
+        skipped[i].album = src->album;
+    }
+
+    httpd_reset_requests();
+    stats_reset();
+    for (size_t i = 0; i < tracks_num; ++i) {
+
+        for (int j = 0; j < skips; ++j) {
+            start_track(widget, &skipped[i * skips + j]);
+            usleep(skip_ms * 1000);
+        }
+
+        uint64_t started = bench_now_ns();
+        start_track(widget, &tracks[i]);
+        wait_track(started, samples);
+    }
+    print_samples(name, samples, tracks_num);
+
+    /* Workers of the skipped tracks may still use them. */
+    sleep(1);
+    for (size_t i = 0; i < skipped_num; ++i) {
+        free(skipped[i].artist);
+        free(skipped[i].title);
+    }
+    free(skipped);
+
+    if (show_stats) {
+        stats_write(stdout);
+        printf("\n");
+    }
+}
+
+static void
+usage(const char *prog) {
+
+    fprintf(stderr, "Usage: %s [-c corpus_dir] [-l latency_ms] [-j jitter_ms] "
+            "[-e error_pct] [-t trunc_pct] [-s skips] [-i skip_interval_ms] [-n connect_ms] [-H] [-v]\n", prog);
+}
+
+int main(int argc, char **argv) {
+
+    const char *corpus_dir = "corpus";
+    HttpdConf conf = { .latency_ms = 50, .jitter_ms = 100 };
+    HttpdConf fail_conf = { .latency_ms = 50, .jitter_ms = 100, .error_pct = 30, .trunc_pct = 10 };
+    HttpdConf down_conf = { .latency_ms = 50, .jitter_ms = 100, .down_host = "lyrics.wikia.com", .down_ms = 500 };
+    int skips = 5, skip_ms = 30;
+    int use_http = 0;
+
+    int opt = 0;
+    while ((opt = getopt(argc, argv, "c:l:j:e:t:s:i:n:Hvh")) != -1) {
+        switch (opt) {
+        case 'c': corpus_dir = optarg;
+            break;
+        case 'l': conf.latency_ms = fail_conf.latency_ms = down_conf.latency_ms = atoi(optarg);
+            break;
+        case 'j': conf.jitter_ms = fail_conf.jitter_ms = down_conf.jitter_ms = atoi(optarg);
+            break;
+        case 'e': fail_conf.error_pct = atoi(optarg);
+            break;
+        case 't': fail_conf.trunc_pct = atoi(optarg);
+            break;
+        case 's': skips = atoi(optarg);
+            break;
+        case 'i': skip_ms = atoi(optarg);
+            break;
+        case 'n': conf.connect_ms = fail_conf.connect_ms = down_conf.connect_ms = atoi(optarg);
+            break;
+        case 'H': use_http = 1;
+            break;
+        case 'v': show_stats = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    init_stub_api();
+
+    httpd_port = httpd_start(corpus_dir);
+    if (httpd_port == -1) {
+        fprintf(stderr, "e2e: can't start fake HTTP server\n");
+        return 1;
+    }
+
+    /* The built-in HTTP client doesn't use stub streams, so it's pointed
+     * to the fake server as to the proxy. */
+    char proxy_port[16] = {0};
+    if (use_http) {
+        snprintf(proxy_port, sizeof(proxy_port), "%d", httpd_port);
+        bench_set_conf("network.proxy", "1");
+        bench_set_conf("network.proxy.address", "127.0.0.1");
+        bench_set_conf("network.proxy.port", proxy_port);
+        bench_set_conf("network.proxy.type", "HTTP");
+    }
+    bench_set_conf(CONF_HTTP_ENABLED, use_http ? "1" : "0");
+
+    char *file = NULL;
+    char **lines = NULL;
+    size_t tracks_num = 0;
+    if (asprintf(&file, "%s/tracks.txt", corpus_dir) == -1 ||
+        bench_load_lines(file, &lines, &tracks_num) == -1 || tracks_num == 0)
+    {
+        fprintf(stderr, "e2e: can't load tracks\n");
+        httpd_stop();
+        return 1;
+    }
+    free(file);
+
+    Track *tracks = calloc(tracks_num, sizeof(Track));
+    for (size_t i = 0; i < tracks_num; ++i) {
+        char *save = NULL;
+        tracks[i].artist = strtok_r(lines[i], "\t", &save);
+        tracks[i].title = strtok_r(NULL, "\t", &save);
+        tracks[i].album = strtok_r(NULL, "\t", &save);
+    }
+
+    Samples samples[VIEWS_NUM] = {{0}};
+    for (int i = 0; i < VIEWS_NUM; ++i)
+        samples[i].values = calloc(tracks_num, sizeof(double));
+
+    DB_plugin_t *plugin = plugin_load(deadbeef);
+    if (plugin->connect() == -1 || !create_widget) {
+        fprintf(stderr, "e2e: can't connect the plug-in\n");
+        httpd_stop();
+        return 1;
+    }
+    ddb_gtkui_widget_t *widget = create_widget();
+    widget->init(widget);
+
+    pthread_t loop_tid;
+    GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+    pthread_create(&loop_tid, NULL, run_main_loop, loop);
+
+    char cache_dir[64] = {0};
+    reset_cache(cache_dir);
+
+    httpd_configure(&conf);
+    run_scenario("cold cache", widget, tracks, tracks_num, 0, 0, samples);
+    run_scenario("warm cache", widget, tracks, tracks_num, 0, 0, samples);
+
+    /* The whole cache is outdated, so it's revalidated with the providers. */
+    nftw(cache_dir, age_entry, 16, FTW_PHYS);
+    bench_set_conf(CONF_LYRICS_UPDATE_PERIOD, "24");
+    run_scenario("stale cache", widget, tracks, tracks_num, 0, 0, samples);
+    bench_set_conf(CONF_LYRICS_UPDATE_PERIOD, NULL);
+
+    reset_cache(cache_dir);
+    run_scenario("rapid track changes", widget, tracks, tracks_num, skips, skip_ms, samples);
+
+    reset_cache(cache_dir);
+    run_stream_scenario("radio stream", widget, tracks, tracks_num, 3);
+
+    /* Only the "Lyrics" tab is ever looked at, so the others
+     * shouldn't be fetched. */
+    reset_cache(cache_dir);
+    __atomic_store_n(&visible_views, 1 << LYR_VIEW, __ATOMIC_RELAXED);
+    run_scenario("lyrics tab only", widget, tracks, tracks_num, 0, 0, samples);
+    __atomic_store_n(&visible_views, (1 << VIEWS_NUM) - 1, __ATOMIC_RELAXED);
+
+    reset_cache(cache_dir);
+    httpd_configure(&fail_conf);
+    run_scenario("provider failures", widget, tracks, tracks_num, 0, 0, samples);
+
+    /* The first lyrics source is down, so it should be moved
+     * to the end of the chain after a few misses. */
+    reset_cache(cache_dir);
+    httpd_configure(&down_conf);
+    run_scenario("first lyrics source down", widget, tracks, tracks_num, 0, 0, samples);
+
+    /* The first lyrics source hangs, so its requests should time out,
+     * until its circuit breaker opens. Adaptive ordering is switched off,
+     * so the source isn't just moved to the end of the chain. */
+    reset_cache(cache_dir);
+    bench_set_conf(CONF_LYRICS_ADAPTIVE, "0");
+    bench_set_conf("infobar.lyricswikia.timeout.connect", "1");
+    bench_set_conf("infobar.lyricswikia.timeout.read", "1");
+    down_conf.down_ms = 10000;
+    httpd_configure(&down_conf);
+    run_scenario("first lyrics source hangs", widget, tracks, tracks_num, 0, 0, samples);
+    bench_set_conf(CONF_LYRICS_ADAPTIVE, NULL);
+    bench_set_conf("infobar.lyricswikia.timeout.connect", NULL);
+    bench_set_conf("infobar.lyricswikia.timeout.read", NULL);
+
+    nftw(cache_dir, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+
+    widget->destroy(widget);
+    free(widget);
+    plugin->disconnect();
+    httpd_stop();
+
+    g_main_loop_quit(loop);
+    pthread_join(loop_tid, NULL);
+    g_main_loop_unref(loop);
+
+    for (int i = 0; i < VIEWS_NUM; ++i)
+        free(samples[i].values);
+
+    free(tracks);
+    bench_free_lines(lines, tracks_num);
+    return 0;
+}
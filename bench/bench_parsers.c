@@ -0,0 +1,183 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "bench.h"
+#include "../utils.h"
+#include "../lyrics.h"
+#include "../similar.h"
+#include "../biography.h"
+
+/* Replays recorded page through the provider's parsing code.
+ * Returns -1 if the page can't be parsed. */
+typedef int (*ParseFunc)(const char *page);
+
+typedef struct {
+    const char *name;
+    const char *file;
+    ParseFunc parse;
+    char *page;
+    size_t size;
+} ParserBench;
+
+static int
+parse_lyricsmania_page(const char *page) {
+
+    char *lyr = NULL;
+    if (parse_common(page, LM_EXP, HTML, &lyr) == -1)
+        return -1;
+
+    free(lyr);
+    return 0;
+}
+
+static int
+parse_lyricstime_page(const char *page) {
+
+    char *lyr = NULL;
+    if (parse_common(page, LT_EXP, HTML, &lyr) == -1)
+        return -1;
+
+    free(lyr);
+    return 0;
+}
+
+static int
+parse_megalyrics_page(const char *page) {
+
+    char *psd = NULL;
+    if (parse_megalyrics(page, &psd) == -1)
+        return -1;
+
+    char *fmd = NULL;
+    if (format_megalyrics(psd, &fmd) == 0)
+        free(fmd);
+
+    free(psd);
+    return 0;
+}
+
+static int
+parse_lyricswikia_page(const char *page) {
+
+    char *xml = NULL;
+    if (parse_common(page, LW_XML_EXP, XML, &xml) == -1)
+        return -1;
+
+    char *lyr = NULL;
+    if (parse_lyricswikia(xml, &lyr) == -1) {
+        free(xml);
+        return -1;
+    }
+    free(xml);
+    free(lyr);
+    return 0;
+}
+
+static int
+parse_bio_txt_page(const char *page) {
+
+    char *bio = NULL;
+    if (parse_bio_txt(page, &bio) == -1)
+        return -1;
+
+    free(bio);
+    return 0;
+}
+
+static int
+parse_bio_img_page(const char *page) {
+
+    char *img_url = NULL;
+    if (parse_bio_img_url(page, IMG_EXTRALARGE, &img_url) == -1)
+        return -1;
+
+    free(img_url);
+    return 0;
+}
+
+static int
+parse_similar_page(const char *page) {
+
+    size_t size = 0;
+    SimilarInfo *similar = NULL;
+    if (parse_similar(page, &similar, &size) == -1)
+        return -1;
+
+    free_sim_list(similar, size);
+    return 0;
+}
+
+/* Recorded responses, relative to the corpus directory. */
+static ParserBench providers[] = {
+    { "lyricswikia", "pages/lyricswikia.xml", parse_lyricswikia_page },
+    { "lyricswikia (multiple)", "pages/lyricswikia_multi.xml", parse_lyricswikia_page },
+    { "lyricsmania", "pages/lyricsmania.html", parse_lyricsmania_page },
+    { "lyricstime", "pages/lyricstime.html", parse_lyricstime_page },
+    { "megalyrics", "pages/megalyrics.html", parse_megalyrics_page },
+    { "lastfm bio", "pages/lastfm_getinfo.xml", parse_bio_txt_page },
+    { "lastfm bio image", "pages/lastfm_getinfo.xml", parse_bio_img_page },
+    { "lastfm similar", "pages/lastfm_getsimilar.xml", parse_similar_page },
+};
+
+static void
+bench_provider(size_t i, void *ctx) {
+
+    ParserBench *prov = ctx;
+    prov->parse(prov->page);
+}
+
+int main(int argc, char **argv) {
+
+    const char *dir = argc > 1 ? argv[1] : "corpus";
+    const char *only = argc > 2 ? argv[2] : NULL;
+
+    bench_init();
+
+    int res = 0;
+    for (size_t i = 0; i < sizeof(providers) / sizeof(providers[0]); ++i) {
+
+        ParserBench *prov = &providers[i];
+        if (only && strcmp(only, prov->name) != 0)
+            continue;
+
+        char *file = NULL;
+        if (asprintf(&file, "%s/%s", dir, prov->file) == -1)
+            return 1;
+
+        if (load_txt_file(file, &prov->page) == -1) {
+            fprintf(stderr, "bench: can't load %s\n", file);
+            free(file);
+            return 1;
+        }
+        free(file);
+        prov->size = strlen(prov->page);
+
+        /* Making sure the recorded page still matches the parser,
+         * otherwise we would be measuring the failure path. */
+        if (prov->parse(prov->page) == -1) {
+            fprintf(stderr, "bench: can't parse %s page\n", prov->name);
+            res = 1;
+        } else {
+            bench_run(prov->name, bench_provider, prov, 1, prov->size);
+        }
+        free(prov->page);
+    }
+    xmlCleanupParser();
+    return res;
+}
@@ -0,0 +1,230 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "bench.h"
+#include "../utils.h"
+
+#define MAX_LYRICS 16
+
+/* Lyrics used as a corpus, relative to the corpus directory. */
+static const char *lyr_files[] = {
+    "lyrics/scarborough_fair.txt",
+    "lyrics/amazing_grace.txt",
+    "lyrics/auld_lang_syne.txt",
+    "lyrics/rising_sun.txt",
+    "lyrics/greensleeves.txt",
+    "lyrics/chorny_voron.txt",
+};
+
+typedef struct {
+    size_t tracks_num;
+    char **artists;
+    char **titles;
+    char **albums;
+    char **redirects;
+    char **matches;
+    size_t lyr_num;
+    char *lyrics[MAX_LYRICS];
+    char *html_lyrics[MAX_LYRICS];
+} Corpus;
+
+static void
+bench_encode_artist(size_t i, void *ctx) {
+
+    Corpus *c = ctx;
+    char *eartist = NULL;
+    if (encode_artist(c->artists[i], &eartist, '+') == 0)
+        free(eartist);
+}
+
+static void
+bench_encode_full(size_t i, void *ctx) {
+
+    Corpus *c = ctx;
+    char *eartist = NULL, *etitle = NULL, *ealbum = NULL;
+    if (encode_full(c->artists[i], c->titles[i], c->albums[i],
+                    &eartist, &etitle, &ealbum) == 0)
+    {
+        free(eartist);
+        free(etitle);
+        free(ealbum);
+    }
+}
+
+static void
+bench_get_redirect_info(size_t i, void *ctx) {
+
+    Corpus *c = ctx;
+    char *artist = NULL, *title = NULL;
+    if (get_redirect_info(c->redirects[i], &artist, &title) == 0) {
+        free(artist);
+        free(title);
+    }
+}
+
+static void
+bench_string_to_perc(size_t i, void *ctx) {
+
+    Corpus *c = ctx;
+    char perc[10] = {0};
+    string_to_perc(c->matches[i], perc);
+}
+
+static void
+bench_replace_all(size_t i, void *ctx) {
+
+    Corpus *c = ctx;
+    char *repl = NULL;
+    if (replace_all(c->html_lyrics[i], "<br/>", "\n", &repl) == 0)
+        free(repl);
+}
+
+static void
+bench_del_nl(size_t i, void *ctx) {
+
+    Corpus *c = ctx;
+    char *wo_nl = NULL;
+    if (del_nl(c->lyrics[i], &wo_nl) == 0)
+        free(wo_nl);
+}
+
+static void
+bench_concat_lyrics(size_t i, void *ctx) {
+
+    Corpus *c = ctx;
+    char *lyr = NULL;
+    if (concat_lyrics(c->lyrics[i], c->lyrics[(i + 1) % c->lyr_num], &lyr) == 0)
+        free(lyr);
+}
+
+/* Loads artist/title/album corpus and derives redirects and
+ * similarity match values from it. */
+static int
+load_tracks(const char *dir, Corpus *c) {
+
+    char *file = NULL;
+    if (asprintf(&file, "%s/tracks.txt", dir) == -1)
+        return -1;
+
+    char **lines = NULL;
+    if (bench_load_lines(file, &lines, &c->tracks_num) == -1) {
+        fprintf(stderr, "bench: can't load %s\n", file);
+        free(file);
+        return -1;
+    }
+    free(file);
+
+    c->artists = calloc(c->tracks_num, sizeof(char*));
+    c->titles = calloc(c->tracks_num, sizeof(char*));
+    c->albums = calloc(c->tracks_num, sizeof(char*));
+    c->redirects = calloc(c->tracks_num, sizeof(char*));
+    c->matches = calloc(c->tracks_num, sizeof(char*));
+
+    for (size_t i = 0; i < c->tracks_num; ++i) {
+        char *save = NULL;
+        char *artist = strtok_r(lines[i], "\t", &save);
+        char *title = strtok_r(NULL, "\t", &save);
+        char *album = strtok_r(NULL, "\t", &save);
+
+        c->artists[i] = strdup(artist ? artist : "");
+        c->titles[i] = strdup(title ? title : "");
+        c->albums[i] = strdup(album ? album : "");
+
+        asprintf(&c->redirects[i], "#REDIRECT [[%s:%s]]", c->artists[i], c->titles[i]);
+        asprintf(&c->matches[i], "%f", (double) (c->tracks_num - i) / c->tracks_num);
+    }
+    bench_free_lines(lines, c->tracks_num);
+    return 0;
+}
+
+/* Loads lyrics corpus and prepares HTML variants of the texts. */
+static int
+load_lyrics(const char *dir, Corpus *c) {
+
+    for (size_t i = 0; i < sizeof(lyr_files) / sizeof(lyr_files[0]); ++i) {
+
+        char *file = NULL;
+        if (asprintf(&file, "%s/%s", dir, lyr_files[i]) == -1)
+            return -1;
+
+        char *lyr = NULL;
+        if (load_txt_file(file, &lyr) == -1) {
+            fprintf(stderr, "bench: can't load %s\n", file);
+            free(file);
+            return -1;
+        }
+        free(file);
+
+        char *html = NULL;
+        if (replace_all(lyr, "\n", "<br/>", &html) == -1)
+            html = strdup(lyr);
+
+        c->lyrics[c->lyr_num] = lyr;
+        c->html_lyrics[c->lyr_num] = html;
+        ++c->lyr_num;
+    }
+    return 0;
+}
+
+/* Frees loaded corpus. */
+static void
+free_corpus(Corpus *c) {
+
+    for (size_t i = 0; i < c->tracks_num; ++i) {
+        free(c->artists[i]);
+        free(c->titles[i]);
+        free(c->albums[i]);
+        free(c->redirects[i]);
+        free(c->matches[i]);
+    }
+    free(c->artists);
+    free(c->titles);
+    free(c->albums);
+    free(c->redirects);
+    free(c->matches);
+
+    for (size_t i = 0; i < c->lyr_num; ++i) {
+        free(c->lyrics[i]);
+        free(c->html_lyrics[i]);
+    }
+}
+
+int main(int argc, char **argv) {
+
+    const char *dir = argc > 1 ? argv[1] : "corpus";
+
+    bench_init();
+
+    Corpus c = {0};
+    if (load_tracks(dir, &c) == -1 || load_lyrics(dir, &c) == -1) {
+        free_corpus(&c);
+        return 1;
+    }
+
+    bench_run("encode_artist", bench_encode_artist, &c, c.tracks_num, 0);
+    bench_run("encode_full", bench_encode_full, &c, c.tracks_num, 0);
+    bench_run("get_redirect_info", bench_get_redirect_info, &c, c.tracks_num, 0);
+    bench_run("string_to_perc", bench_string_to_perc, &c, c.tracks_num, 0);
+    bench_run("replace_all", bench_replace_all, &c, c.lyr_num, 0);
+    bench_run("del_nl", bench_del_nl, &c, c.lyr_num, 0);
+    bench_run("concat_lyrics", bench_concat_lyrics, &c, c.lyr_num, 0);
+
+    free_corpus(&c);
+    return 0;
+}
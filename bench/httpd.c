@@ -0,0 +1,444 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <strings.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "httpd.h"
+
+/* Size of the fake artist's image. */
+#define IMG_SIZE (96 * 1024)
+
+/* Maximum size of the request headers. */
+#define MAX_REQ_SIZE 8192
+
+/* Canned responses never change. */
+#define LAST_MODIFIED "Mon, 01 Jan 2024 00:00:00 GMT"
+
+/* Canned response, chosen by the request's host and path. */
+typedef struct {
+    const char *host;
+    const char *path;
+    const char *file;
+    const char *type;
+    char *body;
+    size_t size;
+    char etag[24];
+} Route;
+
+/* Routes for the URL templates from lyrics.h, biography.h and similar.h. */
+static Route routes[] = {
+    { "lyrics.wikia.com", "/api.php", "pages/lyricswikia.xml", "text/xml" },
+    { "www.lyricsmania.com", "/", "pages/lyricsmania.html", "text/html" },
+    { "www.lyricstime.com", "/", "pages/lyricstime.html", "text/html" },
+    { "megalyrics.ru", "/lyric/", "pages/megalyrics.html", "text/html" },
+    { "ws.audioscrobbler.com", "method=artist.getinfo", "pages/lastfm_getinfo.xml", "text/xml" },
+    { "ws.audioscrobbler.com", "method=artist.getsimilar", "pages/lastfm_getsimilar.xml", "text/xml" },
+    { "userserve-ak.last.fm", "/serve/", NULL, "image/jpeg" },
+};
+
+static int listen_fd = -1;
+static pthread_t accept_tid;
+static pthread_mutex_t conf_mutex = PTHREAD_MUTEX_INITIALIZER;
+static HttpdConf httpd_conf;
+static unsigned int seed = 1;
+static size_t requests;
+static size_t connections;
+static size_t not_modified;
+
+/* Returns random number in [0, 100) range. */
+static int
+random_pct(void) {
+
+    pthread_mutex_lock(&conf_mutex);
+    int res = rand_r(&seed) % 100;
+    pthread_mutex_unlock(&conf_mutex);
+    return res;
+}
+
+/* Tags the response with the hash of its body. */
+static void
+set_etag(Route *route) {
+
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < route->size; ++i)
+        hash = (hash ^ (unsigned char) route->body[i]) * 16777619u;
+
+    snprintf(route->etag, sizeof(route->etag), "\"%08x\"", hash);
+}
+
+/* Checks if the client's copy of the response is still valid. */
+static int
+is_not_modified(const char *req, const Route *route) {
+
+    char value[128] = {0};
+    const char *hdr = strcasestr(req, "\r\nIf-None-Match:");
+    if (hdr && sscanf(hdr + 16, " %127[^\r\n]", value) == 1)
+        return strcmp(value, route->etag) == 0;
+
+    hdr = strcasestr(req, "\r\nIf-Modified-Since:");
+    if (hdr && sscanf(hdr + 20, " %127[^\r\n]", value) == 1)
+        return strcmp(value, LAST_MODIFIED) == 0;
+
+    return 0;
+}
+
+/* Loads canned responses. */
+static int
+load_routes(const char *dir) {
+
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); ++i) {
+
+        Route *route = &routes[i];
+        if (!route->file) {
+            /* Image content doesn't matter, the plug-in just stores it. */
+            route->size = IMG_SIZE;
+            route->body = malloc(IMG_SIZE);
+            if (!route->body)
+                return -1;
+
+            for (size_t j = 0; j < IMG_SIZE; ++j)
+                route->body[j] = (char) (j * 31);
+
+            set_etag(route);
+            continue;
+        }
+
+        char *file = NULL;
+        if (asprintf(&file, "%s/%s", dir, route->file) == -1)
+            return -1;
+
+        FILE *in = fopen(file, "rb");
+        if (!in) {
+            fprintf(stderr, "httpd: can't load %s\n", file);
+            free(file);
+            return -1;
+        }
+        free(file);
+
+        fseek(in, 0, SEEK_END);
+        route->size = ftell(in);
+        rewind(in);
+
+        route->body = malloc(route->size);
+        if (!route->body || fread(route->body, 1, route->size, in) != route->size) {
+            fclose(in);
+            return -1;
+        }
+        fclose(in);
+        set_etag(route);
+    }
+    return 0;
+}
+
+/* Finds canned response for the specified host and path. */
+static Route *
+find_route(const char *host, const char *path) {
+
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); ++i) {
+        if (strcasecmp(routes[i].host, host) == 0 &&
+            strstr(path, routes[i].path))
+        {
+            return &routes[i];
+        }
+    }
+    return NULL;
+}
+
+/* Sends the whole buffer, returns -1 if the peer went away. */
+static int
+send_all(int fd, const char *buf, size_t len) {
+
+    while (len > 0) {
+        ssize_t sent = send(fd, buf, len, MSG_NOSIGNAL);
+        if (sent <= 0)
+            return -1;
+
+        buf += sent;
+        len -= sent;
+    }
+    return 0;
+}
+
+/* Sends response without body. */
+static int
+send_status(int fd, const char *status, int keep_alive) {
+
+    char *resp = NULL;
+    if (asprintf(&resp, "HTTP/1.1 %s\r\nContent-Length: 0\r\nConnection: %s\r\n\r\n",
+                 status, keep_alive ? "keep-alive" : "close") == -1)
+        return -1;
+
+    int res = send_all(fd, resp, strlen(resp));
+    free(resp);
+    return res;
+}
+
+/* Checks if the client wants to keep the connection open. Only HTTP/1.1
+ * clients, which don't ask to close it, get persistent connections. */
+static int
+wants_keep_alive(const char *req) {
+
+    const char *line_end = strstr(req, "\r\n");
+    if (!line_end || line_end - req < 8 || strncmp(line_end - 8, "HTTP/1.1", 8) != 0)
+        return 0;
+
+    const char *conn = strcasestr(req, "\r\nConnection:");
+    if (!conn)
+        conn = strcasestr(req, "\r\nProxy-Connection:");
+
+    if (conn) {
+        conn = strchr(conn, ':') + 1;
+        while (*conn == ' ')
+            ++conn;
+
+        if (strncasecmp(conn, "close", 5) == 0)
+            return 0;
+    }
+    return 1;
+}
+
+/* Serves single request. Returns -1 if the connection must be closed. */
+static int
+serve_request(int fd) {
+
+    char req[MAX_REQ_SIZE + 1] = {0};
+    size_t len = 0;
+    while (len < MAX_REQ_SIZE && !strstr(req, "\r\n\r\n")) {
+        ssize_t got = recv(fd, req + len, MAX_REQ_SIZE - len, 0);
+        if (got <= 0)
+            break;
+        len += got;
+    }
+
+    /* The client closed idle connection. */
+    if (len == 0)
+        return -1;
+
+    char path[MAX_REQ_SIZE] = {0};
+    char host[256] = {0};
+    if (sscanf(req, "GET %8191s", path) != 1) {
+        send_status(fd, "400 Bad Request", 0);
+        return -1;
+    }
+    int keep_alive = wants_keep_alive(req);
+
+    const char *host_hdr = strcasestr(req, "\r\nHost:");
+    if (host_hdr)
+        sscanf(host_hdr + 7, " %255[^:\r\n]", host);
+
+    pthread_mutex_lock(&conf_mutex);
+    HttpdConf conf = httpd_conf;
+    ++requests;
+    pthread_mutex_unlock(&conf_mutex);
+
+    int delay = conf.latency_ms;
+    if (conf.jitter_ms > 0)
+        delay += random_pct() * conf.jitter_ms / 100;
+
+    if (delay > 0)
+        usleep(delay * 1000);
+
+    int down = conf.down_host && strcasecmp(conf.down_host, host) == 0;
+    if (down && conf.down_ms > 0)
+        usleep(conf.down_ms * 1000);
+
+    Route *route = find_route(host, path);
+    if (!route)
+        return send_status(fd, "404 Not Found", keep_alive) == 0 && keep_alive ? 0 : -1;
+
+    if (down || random_pct() < conf.error_pct)
+        return send_status(fd, "503 Service Unavailable", keep_alive) == 0 && keep_alive ? 0 : -1;
+
+    if (is_not_modified(req, route)) {
+        pthread_mutex_lock(&conf_mutex);
+        ++not_modified;
+        pthread_mutex_unlock(&conf_mutex);
+        return send_status(fd, "304 Not Modified", keep_alive) == 0 && keep_alive ? 0 : -1;
+    }
+
+    /* Truncated responses still announce the full length,
+     * like a connection dropped in the middle of the transfer. */
+    size_t body_len = route->size;
+    if (random_pct() < conf.trunc_pct) {
+        body_len = route->size / 2;
+        keep_alive = 0;
+    }
+
+    char *hdr = NULL;
+    if (asprintf(&hdr, "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                 "ETag: %s\r\nLast-Modified: " LAST_MODIFIED "\r\nConnection: %s\r\n\r\n",
+                 route->type, route->size, route->etag, keep_alive ? "keep-alive" : "close") == -1)
+        return -1;
+
+    int res = send_all(fd, hdr, strlen(hdr));
+    if (res == 0)
+        res = send_all(fd, route->body, body_len);
+
+    free(hdr);
+    return res == 0 && keep_alive ? 0 : -1;
+}
+
+/* Serves requests of the single connection, until the client closes it. */
+static void *
+serve_client(void *ctx) {
+
+    int fd = (int) (intptr_t) ctx;
+
+    pthread_mutex_lock(&conf_mutex);
+    int connect_ms = httpd_conf.connect_ms;
+    ++connections;
+    pthread_mutex_unlock(&conf_mutex);
+
+    /* Setting up the connection costs extra round trips. */
+    if (connect_ms > 0)
+        usleep(connect_ms * 1000);
+
+    while (serve_request(fd) == 0)
+        ;
+
+    close(fd);
+    return NULL;
+}
+
+/* Accepts incoming connections and serves each one on its own thread. */
+static void *
+accept_clients(void *ctx) {
+
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd == -1)
+            break;
+
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, serve_client, (void*) (intptr_t) fd) != 0) {
+            close(fd);
+            continue;
+        }
+        pthread_detach(tid);
+    }
+    return NULL;
+}
+
+/* Starts fake HTTP server on the loopback interface. */
+int httpd_start(const char *corpus_dir) {
+
+    if (load_routes(corpus_dir) == -1)
+        return -1;
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd == -1)
+        return -1;
+
+    int on = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    socklen_t addr_len = sizeof(addr);
+    if (bind(listen_fd, (struct sockaddr*) &addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, 128) != 0 ||
+        getsockname(listen_fd, (struct sockaddr*) &addr, &addr_len) != 0)
+    {
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+
+    if (pthread_create(&accept_tid, NULL, accept_clients, NULL) != 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+    return ntohs(addr.sin_port);
+}
+
+/* Stops fake HTTP server. */
+void httpd_stop(void) {
+
+    if (listen_fd == -1)
+        return;
+
+    shutdown(listen_fd, SHUT_RDWR);
+    close(listen_fd);
+    pthread_join(accept_tid, NULL);
+    listen_fd = -1;
+
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); ++i) {
+        free(routes[i].body);
+        routes[i].body = NULL;
+    }
+}
+
+/* Changes behaviour of the fake HTTP server. */
+void httpd_configure(const HttpdConf *conf) {
+
+    pthread_mutex_lock(&conf_mutex);
+    httpd_conf = *conf;
+    pthread_mutex_unlock(&conf_mutex);
+}
+
+/* Returns number of requests served since the last reset. */
+size_t httpd_requests(void) {
+
+    pthread_mutex_lock(&conf_mutex);
+    size_t res = requests;
+    pthread_mutex_unlock(&conf_mutex);
+    return res;
+}
+
+/* Returns number of accepted connections since the last reset. */
+size_t httpd_connections(void) {
+
+    pthread_mutex_lock(&conf_mutex);
+    size_t res = connections;
+    pthread_mutex_unlock(&conf_mutex);
+    return res;
+}
+
+/* Returns number of requests answered with "304 Not Modified"
+ * since the last reset. */
+size_t httpd_not_modified(void) {
+
+    pthread_mutex_lock(&conf_mutex);
+    size_t res = not_modified;
+    pthread_mutex_unlock(&conf_mutex);
+    return res;
+}
+
+/* Resets number of served requests and accepted connections. */
+void httpd_reset_requests(void) {
+
+    pthread_mutex_lock(&conf_mutex);
+    requests = 0;
+    connections = 0;
+    not_modified = 0;
+    pthread_mutex_unlock(&conf_mutex);
+}
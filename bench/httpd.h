@@ -0,0 +1,69 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_HTTPD_HEADER
+#define INFOBAR_HTTPD_HEADER
+
+#include <stddef.h>
+
+/* Behaviour of the fake HTTP server. Can be changed at any time,
+ * new values are applied to the following requests. */
+typedef struct {
+    /* Delay before sending the response. */
+    int latency_ms;
+    /* Random addition to the delay. */
+    int jitter_ms;
+    /* Percentage of requests answered with "503 Service Unavailable". */
+    int error_pct;
+    /* Percentage of responses closed after sending half of the body. */
+    int trunc_pct;
+    /* Host, which answers every request with "503 Service Unavailable"
+     * after down_ms delay, like a dead provider. */
+    const char *down_host;
+    int down_ms;
+    /* Delay before serving the first request of the connection,
+     * like TCP and TLS handshakes. */
+    int connect_ms;
+} HttpdConf;
+
+/* Starts fake HTTP server on the loopback interface, serving canned
+ * responses from the specified corpus directory. Returns listening port
+ * or -1 in case of error. */
+int httpd_start(const char *corpus_dir);
+
+/* Stops fake HTTP server. */
+void httpd_stop(void);
+
+/* Changes behaviour of the fake HTTP server. */
+void httpd_configure(const HttpdConf *conf);
+
+/* Returns number of requests served since the last reset. */
+size_t httpd_requests(void);
+
+/* Returns number of accepted connections since the last reset. */
+size_t httpd_connections(void);
+
+/* Returns number of requests answered with "304 Not Modified"
+ * since the last reset. */
+size_t httpd_not_modified(void);
+
+/* Resets number of served requests and accepted connections. */
+void httpd_reset_requests(void);
+
+#endif
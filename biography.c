@@ -19,6 +19,9 @@
 
 #include "biography.h"
 
+/* Approximate size in pixels of the longer side of lastfm's images. */
+static const int img_pixels[IMG_SIZES_COUNT] = { 34, 64, 174, 300, 500 };
+
 /* Forms an URL, which is used to retrieve artists's biography and image. */
 static int 
 form_bio_url(const char *artist, char **url) {
@@ -40,62 +43,106 @@ form_bio_url(const char *artist, char **url) {
     return 0;
 }
 
+/* Parses artist's biography from the lastfm XML response. */
+int parse_bio_txt(const char *content, char **bio) {
+    
+    char *xml = NULL;
+    if (parse_common(content, BIO_TXT_XML_EXP, XML, &xml) == -1)
+        return -1;
+    
+    char *html = NULL;
+    if (parse_common(xml, BIO_TXT_HTML_EXP, HTML, &html) == -1) {
+        free(xml);
+        return -1;
+    }
+    free(xml);
+    *bio = html;
+    return 0;
+}
+
 /* Fetches artist's biography from lastfm. */
-int fetch_bio_txt(const char *artist, char **bio) {
+int fetch_bio_txt(const char *artist, Validators *val, char **bio) {
     
     char *url = NULL;
     if (form_bio_url(artist, &url) == -1)
         return -1;
     
     char *raw_page = NULL;
-    if (retrieve_txt_content(url, &raw_page) == -1) {
+    int res = retrieve_txt_content(url, LASTFM_BIO, val, &raw_page);
+    if (res != 0) {
         free(url);
-        return -1;
+        return res;
     }
     free(url);
 
-    char *xml = NULL;
-    if (parse_common(raw_page, BIO_TXT_XML_EXP, XML, &xml) == -1) {
+    if (parse_bio_txt(raw_page, bio) == -1) {
+        stats_parse_failure(LASTFM_BIO);
         free(raw_page);
         return -1;
     }
     free(raw_page);
-    
-    char *html = NULL;
-    if (parse_common(xml, BIO_TXT_HTML_EXP, HTML, &html) == -1) {
-        free(xml);
+    return 0;
+}
+
+/* Parses the URL of artist's image of the specified size from
+ * the lastfm XML response. */
+int parse_bio_img_url(const char *content, ImgSize size, char **img_url) {
+
+    char *exp = NULL;
+    if (asprintf(&exp, BIO_IMG_EXP_TEMP, img_size_name(size)) == -1)
         return -1;
+
+    int res = parse_common(content, exp, XML, img_url);
+    free(exp);
+    return res;
+}
+
+/* Chooses the smallest size of artist's image, which is still sharp in
+ * the area of the specified size in device pixels. */
+ImgSize choose_img_size(int width, int height) {
+
+    if (width <= 0 || height <= 0)
+        return IMG_EXTRALARGE;
+
+    /* Images are mostly square, so they are fit by the shorter side. */
+    int side = width < height ? width : height;
+    for (int size = IMG_SMALL; size < IMG_MEGA; ++size) {
+        if (img_pixels[size] >= side)
+            return size;
     }
-    free(xml);
-    *bio = html;
-    return 0;
+    return IMG_MEGA;
 }
 
-/* Fetches artist's image from lastfm. Retrieved image will
- * be saved to the specified path. */
-int fetch_bio_image(const char *artist, const char *path) {
+/* Fetches artist's image of the specified size from lastfm. Retrieved
+ * image will be saved to the specified path. */
+int fetch_bio_image(const char *artist, ImgSize size, const char *path, ImgSink *sink) {
     
     char *url = NULL;
     if (form_bio_url(artist, &url) == -1)
         return -1;
 
     char *raw_page = NULL;
-    if (retrieve_txt_content(url, &raw_page) == -1) {
+    int res = retrieve_txt_content(url, LASTFM_IMAGE, NULL, &raw_page);
+    if (res != 0) {
         free(url);
-        return -1;
+        return res;
     }
     free(url);
     
     char *img_url = NULL;
-    if (parse_common(raw_page, BIO_IMG_EXP, XML, &img_url) == -1) {
+    if (parse_bio_img_url(raw_page, size, &img_url) == -1 &&
+        (size == IMG_EXTRALARGE || parse_bio_img_url(raw_page, IMG_EXTRALARGE, &img_url) == -1))
+    {
+        stats_parse_failure(LASTFM_IMAGE);
         free(raw_page);
         return -1;
     }
     free(raw_page);
     
-    if (retrieve_img_content(img_url, path) == -1) {
+    res = retrieve_img_content(img_url, LASTFM_IMAGE, path, sink);
+    if (res != 0) {
         free(img_url);
-        return -1;
+        return res;
     }
     free(img_url);
     return 0;
@@ -25,7 +25,7 @@
 #include <string.h>
 #include <deadbeef/deadbeef.h>
 
-#include "infobar.h"
+#include "core.h"
 #include "utils.h"
 
 /* URL template to access artist's info on lastfm. */
@@ -34,13 +34,27 @@
 /* XPath expressions. */
 #define BIO_TXT_HTML_EXP "/html/body"
 #define BIO_TXT_XML_EXP "/lfm/artist/bio/content"
-#define BIO_IMG_EXP "//image[@size=\"extralarge\"]"
+#define BIO_IMG_EXP_TEMP "//image[@size=\"%s\"]"
 
-/* Fetches artist's biography from lastfm. */
-int fetch_bio_txt(const char *artist, char **bio);
+/* Parses artist's biography from the lastfm XML response. */
+int parse_bio_txt(const char *content, char **bio);
 
-/* Fetches artist's image from lastfm. Retrieved image will
- * be saved to the specified path. */
-int fetch_bio_image(const char *artist, const char *path);
+/* Parses the URL of artist's image of the specified size from
+ * the lastfm XML response. */
+int parse_bio_img_url(const char *content, ImgSize size, char **img_url);
+
+/* Fetches artist's biography from lastfm. If validators of the cached
+ * biography are specified, the request is conditional. */
+int fetch_bio_txt(const char *artist, Validators *val, char **bio);
+
+/* Chooses the smallest size of artist's image, which is still sharp in
+ * the area of the specified size in device pixels. Extralarge image is
+ * chosen, if the size of the area is unknown (0). */
+ImgSize choose_img_size(int width, int height);
+
+/* Fetches artist's image of the specified size from lastfm. Extralarge
+ * image is fetched, if there is no image of that size. Retrieved image
+ * will be saved to the specified path and passed to the sink, if any. */
+int fetch_bio_image(const char *artist, ImgSize size, const char *path, ImgSink *sink);
 
 #endif
@@ -0,0 +1,205 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "breaker.h"
+#include "core.h"
+
+#define MAX_STATE_SIZE 512
+
+typedef struct {
+    BreakerState state;
+    int failures;
+    int backoff;
+    int probing;
+    uint64_t open_until;
+} Breaker;
+
+static Breaker breakers[PROVIDERS_COUNT];
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Describes states of all breakers, which aren't closed. Should be
+ * called with the mutex held. */
+static void
+describe_breakers(char *desc, size_t size) {
+
+    size_t len = 0;
+    uint64_t now = stats_now();
+    desc[0] = 0;
+
+    for (int i = 0; i < PROVIDERS_COUNT && len < size; ++i) {
+        Breaker *br = &breakers[i];
+        if (br->state == BREAKER_CLOSED)
+            continue;
+
+        if (br->state == BREAKER_OPEN && br->open_until > now) {
+            len += snprintf(desc + len, size - len, "%s%s: open for %ds", len ? ", " : "",
+                    provider_name(i), (int) ((br->open_until - now) / 1000000000ULL) + 1);
+        } else {
+            len += snprintf(desc + len, size - len, "%s%s: %s", len ? ", " : "",
+                    provider_name(i), breaker_state_name(BREAKER_HALF_OPEN));
+        }
+    }
+    if (len == 0)
+        snprintf(desc, size, "all closed");
+}
+
+/* Publishes states of the breakers to the configuration, so they can be
+ * seen in the plug-in's settings dialog. */
+static void
+publish_state(const char *desc) {
+
+    deadbeef->conf_set_str(CONF_BREAKER_STATE, desc);
+}
+
+/* Opens the breaker, doubling the back-off time if it's reopened after
+ * a failed probe. Should be called with the mutex held. */
+static void
+open_breaker(Breaker *br) {
+
+    int base = deadbeef->conf_get_int(CONF_BREAKER_BACKOFF, DEF_BREAKER_BACKOFF);
+    if (br->state == BREAKER_HALF_OPEN && br->backoff < base * BREAKER_MAX_BACKOFF)
+        br->backoff = br->backoff ? br->backoff * 2 : base;
+    else if (br->state == BREAKER_CLOSED)
+        br->backoff = base;
+
+    br->state = BREAKER_OPEN;
+    br->probing = 0;
+    br->open_until = stats_now() + br->backoff * 1000000000ULL;
+}
+
+/* Checks if a request to the specified provider can be made. */
+int breaker_allow(Provider prov) {
+
+    if (deadbeef->conf_get_int(CONF_BREAKER_THRESHOLD, DEF_BREAKER_THRESHOLD) <= 0)
+        return 1;
+
+    char desc[MAX_STATE_SIZE] = {0};
+    Breaker *br = &breakers[prov];
+    int allow = 1;
+
+    pthread_mutex_lock(&mutex);
+    switch (br->state) {
+    case BREAKER_CLOSED:
+        break;
+    case BREAKER_OPEN:
+        if (stats_now() < br->open_until) {
+            allow = 0;
+            break;
+        }
+        trace("infobar: probing %s\n", provider_name(prov));
+        br->state = BREAKER_HALF_OPEN;
+        br->probing = 1;
+        describe_breakers(desc, sizeof(desc));
+        break;
+    case BREAKER_HALF_OPEN:
+        /* Only one probe at a time. */
+        allow = !br->probing;
+        br->probing = 1;
+        break;
+    }
+    pthread_mutex_unlock(&mutex);
+
+    if (*desc)
+        publish_state(desc);
+    return allow;
+}
+
+/* Records successful request to the specified provider. */
+void breaker_success(Provider prov) {
+
+    char desc[MAX_STATE_SIZE] = {0};
+    Breaker *br = &breakers[prov];
+
+    pthread_mutex_lock(&mutex);
+    br->failures = 0;
+    if (br->state != BREAKER_CLOSED) {
+        br->state = BREAKER_CLOSED;
+        br->probing = 0;
+        br->backoff = 0;
+        describe_breakers(desc, sizeof(desc));
+    }
+    pthread_mutex_unlock(&mutex);
+
+    if (*desc)
+        publish_state(desc);
+}
+
+/* Records failed or timed out request to the specified provider. */
+void breaker_failure(Provider prov) {
+
+    int threshold = deadbeef->conf_get_int(CONF_BREAKER_THRESHOLD, DEF_BREAKER_THRESHOLD);
+    if (threshold <= 0)
+        return;
+
+    char desc[MAX_STATE_SIZE] = {0};
+    Breaker *br = &breakers[prov];
+
+    pthread_mutex_lock(&mutex);
+    ++br->failures;
+    if (br->state == BREAKER_HALF_OPEN ||
+        (br->state == BREAKER_CLOSED && br->failures >= threshold))
+    {
+        trace("infobar: opening circuit breaker of %s\n", provider_name(prov));
+        open_breaker(br);
+        describe_breakers(desc, sizeof(desc));
+    }
+    pthread_mutex_unlock(&mutex);
+
+    if (*desc)
+        publish_state(desc);
+}
+
+/* Returns current state of the breaker of the specified provider. An open
+ * breaker, which back-off time is over, is reported as half-open. */
+BreakerState breaker_state(Provider prov) {
+
+    pthread_mutex_lock(&mutex);
+    BreakerState state = breakers[prov].state;
+    if (state == BREAKER_OPEN && stats_now() >= breakers[prov].open_until)
+        state = BREAKER_HALF_OPEN;
+    pthread_mutex_unlock(&mutex);
+    return state;
+}
+
+/* Returns printable name of the breaker state. */
+const char *breaker_state_name(BreakerState state) {
+
+    switch (state) {
+    case BREAKER_OPEN:
+        return "open";
+    case BREAKER_HALF_OPEN:
+        return "half-open";
+    default:
+        return "closed";
+    }
+}
+
+/* Closes all breakers. */
+void breaker_reset(void) {
+
+    pthread_mutex_lock(&mutex);
+    memset(breakers, 0, sizeof(breakers));
+    pthread_mutex_unlock(&mutex);
+
+    publish_state("all closed");
+}
@@ -0,0 +1,59 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_BREAKER_HEADER
+#define INFOBAR_BREAKER_HEADER
+
+#include "types.h"
+
+/* Default number of consecutive failures, which opens the breaker. */
+#define DEF_BREAKER_THRESHOLD 5
+
+/* Default time in seconds the breaker stays open. It's doubled after
+ * each failed probe, up to BREAKER_MAX_BACKOFF times. */
+#define DEF_BREAKER_BACKOFF 60
+#define BREAKER_MAX_BACKOFF 16
+
+typedef enum {
+    BREAKER_CLOSED = 0,
+    BREAKER_OPEN = 1,
+    BREAKER_HALF_OPEN = 2,
+} BreakerState;
+
+/* Checks if a request to the specified provider can be made. While
+ * the breaker is open, requests are rejected. Once the back-off time
+ * is over, a single probe request is let through. */
+int breaker_allow(Provider prov);
+
+/* Records successful request to the specified provider. */
+void breaker_success(Provider prov);
+
+/* Records failed or timed out request to the specified provider. */
+void breaker_failure(Provider prov);
+
+/* Returns current state of the breaker of the specified provider. */
+BreakerState breaker_state(Provider prov);
+
+/* Returns printable name of the breaker state. */
+const char *breaker_state_name(BreakerState state);
+
+/* Closes all breakers. */
+void breaker_reset(void);
+
+#endif
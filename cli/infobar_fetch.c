@@ -0,0 +1,385 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/* Command line tool to look up lyrics, biographies and similar artists
+ * using the plug-in's core, without deadbeef and without a display.
+ * Results are stored in the same cache the plug-in uses, so it can be
+ * used to warm the cache up for a whole playlist. */
+
+#include <unistd.h>
+#include <curl/curl.h>
+
+#include "../core.h"
+#include "../utils.h"
+#include "../similar.h"
+
+#define MAX_CONF_ITEMS 64
+#define FETCH_TIMEOUT 30L
+
+/* Lookups to perform for each track. */
+typedef enum {
+    LOOKUP_LYRICS = 1 << 0,
+    LOOKUP_BIO = 1 << 1,
+    LOOKUP_SIMILAR = 1 << 2,
+} LookupType;
+
+/* Downloaded content, served by fread. */
+typedef struct {
+    DB_FILE file;
+    char *data;
+    size_t size;
+    size_t pos;
+} MemFile;
+
+/* Configuration item, set from the command line. */
+typedef struct {
+    const char *key;
+    const char *value;
+} ConfItem;
+
+static ConfItem conf_items[MAX_CONF_ITEMS];
+static size_t conf_size;
+
+static const char *
+find_conf(const char *key) {
+
+    for (size_t i = 0; i < conf_size; ++i) {
+        if (strcmp(conf_items[i].key, key) == 0)
+            return conf_items[i].value;
+    }
+    return NULL;
+}
+
+static const char *
+host_conf_get_str_fast(const char *key, const char *def) {
+
+    const char *value = find_conf(key);
+    return value ? value : def;
+}
+
+static int
+host_conf_get_int(const char *key, int def) {
+
+    const char *value = find_conf(key);
+    return value ? atoi(value) : def;
+}
+
+/* Configuration isn't saved, the tool's state lives only as long as it runs. */
+static void
+host_conf_set_str(const char *key, const char *value) {}
+
+static void
+host_lock(void) {}
+
+/* Charset detection is left to the player, the tool keeps
+ * the content as is. */
+static const char *
+host_junk_detect_charset(const char *str) {
+    return NULL;
+}
+
+static size_t
+write_mem(char *ptr, size_t size, size_t nmemb, void *ctx) {
+
+    MemFile *file = ctx;
+    size_t len = size * nmemb;
+
+    char *data = realloc(file->data, file->size + len + 1);
+    if (!data)
+        return 0;
+
+    memcpy(data + file->size, ptr, len);
+    file->data = data;
+    file->size += len;
+    file->data[file->size] = 0;
+    return len;
+}
+
+/* Downloads the whole content of the specified URL. */
+static DB_FILE *
+host_fopen(const char *url) {
+
+    MemFile *file = calloc(1, sizeof(MemFile));
+    if (!file)
+        return NULL;
+
+    CURL *curl = curl_easy_init();
+    if (!curl) {
+        free(file);
+        return NULL;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, FETCH_TIMEOUT);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "deadbeef");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_mem);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, file);
+
+    CURLcode res = curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+
+    if (res != CURLE_OK) {
+        trace("infobar-fetch: %s: %s\n", url, curl_easy_strerror(res));
+        free(file->data);
+        free(file);
+        return NULL;
+    }
+    return &file->file;
+}
+
+static size_t
+host_fread(void *ptr, size_t size, size_t nmemb, DB_FILE *stream) {
+
+    MemFile *file = (MemFile*) stream;
+
+    size_t len = size * nmemb;
+    if (len > file->size - file->pos)
+        len = file->size - file->pos;
+
+    memcpy(ptr, file->data + file->pos, len);
+    file->pos += len;
+    return len / size;
+}
+
+/* Content is downloaded at once by host_fopen(), so there is nothing
+ * to abort. Its own curl timeout bounds the download instead. */
+static void
+host_fabort(DB_FILE *stream) {}
+
+static void
+host_fclose(DB_FILE *stream) {
+
+    MemFile *file = (MemFile*) stream;
+    free(file->data);
+    free(file);
+}
+
+/* Subset of deadbeef API used by the plug-in's core. */
+static DB_functions_t host_api = {
+    .conf_lock = host_lock,
+    .conf_unlock = host_lock,
+    .conf_get_str_fast = host_conf_get_str_fast,
+    .conf_get_int = host_conf_get_int,
+    .conf_set_str = host_conf_set_str,
+    .junk_detect_charset = host_junk_detect_charset,
+    .fopen = host_fopen,
+    .fread = host_fread,
+    .fabort = host_fabort,
+    .fclose = host_fclose,
+};
+
+/* Performs the requested lookups for a single track. */
+static int
+lookup_track(const char *artist, const char *title, const char *album, int types, int quiet) {
+
+    int res = 0;
+
+    if ((types & LOOKUP_LYRICS) && title && *title) {
+        char *lyr = NULL;
+        if (lookup_track_lyrics(artist, title, album ? album : "", &lyr) == 0) {
+            if (!quiet)
+                printf("== Lyrics: %s - %s ==\n%s\n\n", artist, title, lyr);
+            free(lyr);
+        } else {
+            fprintf(stderr, "infobar-fetch: lyrics not found: %s - %s\n", artist, title);
+            res = -1;
+        }
+    }
+
+    if (types & LOOKUP_BIO) {
+        char *bio = NULL, *img = NULL;
+        if (lookup_artist_bio(artist, IMG_EXTRALARGE, &bio, &img, NULL) == 0 && bio) {
+            if (!quiet)
+                printf("== Biography: %s ==\n%s\n\n", artist, bio);
+        } else {
+            fprintf(stderr, "infobar-fetch: biography not found: %s\n", artist);
+            res = -1;
+        }
+        free(bio);
+        free(img);
+    }
+
+    if (types & LOOKUP_SIMILAR) {
+        size_t size = 0;
+        SimilarInfo *similar = NULL;
+        if (lookup_similar_artists(artist, &similar, &size) == 0) {
+            if (!quiet) {
+                printf("== Similar to: %s ==\n", artist);
+                for (size_t i = 0; i < size; ++i) {
+                    char perc[10] = {0};
+                    if (!similar[i].match || string_to_perc(similar[i].match, perc) == -1)
+                        perc[0] = 0;
+                    printf("%s\t%s\n", similar[i].name ? similar[i].name : "", perc);
+                }
+                printf("\n");
+            }
+            free_sim_list(similar, size);
+        } else {
+            fprintf(stderr, "infobar-fetch: similar artists not found: %s\n", artist);
+            res = -1;
+        }
+    }
+    return res;
+}
+
+/* Reads tracks from the specified stream, one "artist<TAB>title<TAB>album"
+ * per line, and performs the requested lookups for each of them. */
+static int
+lookup_batch(FILE *in, int types, int quiet) {
+
+    int res = 0;
+    char *line = NULL;
+    size_t cap = 0;
+
+    while (getline(&line, &cap, in) != -1) {
+
+        line[strcspn(line, "\r\n")] = 0;
+        if (*line == 0)
+            continue;
+
+        /* Fields are split on every tab, so empty ones keep their place. */
+        char *rest = line;
+        char *artist = strsep(&rest, "\t");
+        char *title = strsep(&rest, "\t");
+        char *album = strsep(&rest, "\t");
+
+        if (!artist || *artist == 0) {
+            fprintf(stderr, "infobar-fetch: skipping line without artist\n");
+            continue;
+        }
+
+        if (lookup_track(artist, title, album, types, quiet) == -1)
+            res = -1;
+    }
+    free(line);
+    return res;
+}
+
+static void
+usage(const char *prog) {
+
+    fprintf(stderr,
+        "Usage: %s [options] artist [title [album]]\n"
+        "       %s [options] -f file\n"
+        "Looks up lyrics, biography and similar artists, storing them in\n"
+        "the infobar cache.\n\n"
+        "  -l            look up lyrics\n"
+        "  -b            look up biography\n"
+        "  -s            look up similar artists\n"
+        "  -f file       read \"artist<TAB>title<TAB>album\" lines from file (- for stdin)\n"
+        "  -q            don't print results, just warm the cache up\n"
+        "  -t file       record timing spans and write them to file (Chrome JSON)\n"
+        "  -S file       write provider and cache statistics to file (- for stderr)\n"
+        "  -o key=value  set plug-in option, e.g. -o infobar.bio.locale=de\n\n"
+        "If none of -l, -b and -s is given, everything is looked up.\n",
+        prog, prog);
+}
+
+int main(int argc, char **argv) {
+
+    int types = 0, quiet = 0;
+    const char *batch = NULL, *trace = NULL, *stats = NULL;
+
+    int opt = 0;
+    while ((opt = getopt(argc, argv, "lbsf:qt:S:o:h")) != -1) {
+        switch (opt) {
+        case 'l': types |= LOOKUP_LYRICS;
+            break;
+        case 'b': types |= LOOKUP_BIO;
+            break;
+        case 's': types |= LOOKUP_SIMILAR;
+            break;
+        case 'f': batch = optarg;
+            break;
+        case 'q': quiet = 1;
+            break;
+        case 't': trace = optarg;
+            break;
+        case 'S': stats = optarg;
+            break;
+        case 'o':
+        {
+            char *eq = strchr(optarg, '=');
+            if (!eq || conf_size == MAX_CONF_ITEMS) {
+                usage(argv[0]);
+                return 1;
+            }
+            *eq = 0;
+            conf_items[conf_size].key = optarg;
+            conf_items[conf_size].value = eq + 1;
+            ++conf_size;
+        }
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!batch && optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (types == 0)
+        types = LOOKUP_LYRICS | LOOKUP_BIO | LOOKUP_SIMILAR;
+
+    deadbeef = &host_api;
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    xmlInitParser();
+    spans_set_enabled(trace != NULL);
+
+    int res = 0;
+    if (batch) {
+        FILE *in = strcmp(batch, "-") == 0 ? stdin : fopen(batch, "r");
+        if (!in) {
+            fprintf(stderr, "infobar-fetch: can't open %s\n", batch);
+            res = -1;
+        } else {
+            res = lookup_batch(in, types, quiet);
+            if (in != stdin)
+                fclose(in);
+        }
+    } else {
+        const char *title = optind + 1 < argc ? argv[optind + 1] : NULL;
+        const char *album = optind + 2 < argc ? argv[optind + 2] : NULL;
+        res = lookup_track(argv[optind], title, album, types, quiet);
+    }
+
+    if (stats) {
+        if (strcmp(stats, "-") == 0)
+            stats_write(stderr);
+        else if (stats_dump(stats) == -1)
+            fprintf(stderr, "infobar-fetch: can't write %s\n", stats);
+    }
+
+    if (trace) {
+        spans_log_stats(stderr);
+        if (spans_export_json(trace) == -1)
+            fprintf(stderr, "infobar-fetch: can't write %s\n", trace);
+    }
+
+    watchdog_shutdown();
+    http_shutdown();
+    xmlCleanupParser();
+    curl_global_cleanup();
+    return res == 0 ? 0 : 2;
+}
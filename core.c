@@ -0,0 +1,313 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "core.h"
+#include "utils.h"
+#include "lyrics.h"
+#include "biography.h"
+#include "similar.h"
+#include "ranking.h"
+
+/* deadbeef API. */
+DB_functions_t *deadbeef;
+
+/* Lyrics providers in the default order, and their settings. */
+static const Provider lyrics_providers[RANKED_PROVIDERS] = {
+    LYRICSWIKIA, LYRICSMANIA, LYRICSTIME, MEGALYRICS,
+};
+
+static const char *lyrics_providers_conf[RANKED_PROVIDERS] = {
+    CONF_LYRICSWIKIA_ENABLED,
+    CONF_LYRICSMANIA_ENABLED,
+    CONF_LYRICSTIME_ENABLED,
+    CONF_MEGALYRICS_ENABLED,
+};
+
+/* Makes sure, that specified text has UTF-8 encoding, otherwise converts it. */
+static void
+ensure_utf8(char **txt) {
+
+    uint64_t span = span_begin();
+    char *utf8 = NULL;
+    if (deadbeef->junk_detect_charset(*txt)) {
+        if (convert_to_utf8(*txt, &utf8) == 0) {
+            free(*txt);
+            *txt = utf8;
+        }
+    }
+    span_end(span, "charset", SPAN_TEXT);
+}
+
+/* Checks if the specified cache file can be used and records the result. */
+static CacheState
+check_cache(const char *cache_file, CacheType type) {
+
+    CacheState state = CACHE_HIT;
+    if (!is_exists(cache_file))
+        state = CACHE_MISS;
+    else if (is_old_cache(cache_file, type))
+        state = CACHE_STALE;
+
+    stats_cache(type, state);
+    return state;
+}
+
+/* Moves the specified provider to the front of the order, keeping
+ * the order of the rest. */
+static void
+move_to_front(Provider *order, size_t size, Provider prov) {
+
+    for (size_t i = 1; i < size; ++i) {
+        if (order[i] == prov) {
+            memmove(order + 1, order, i * sizeof(Provider));
+            order[0] = prov;
+            return;
+        }
+    }
+}
+
+/* Fetches lyrics from the specified provider, recording its latency and outcome.
+ * Requests rejected by the circuit breaker are neither attempts nor samples
+ * of the provider's latency. */
+static int
+fetch_lyrics(Provider prov, const char *artist, const char *title, const char *album,
+             Validators *val, char **lyr) {
+
+    uint64_t span = span_begin();
+    uint64_t begin = stats_now();
+
+    int res = -1;
+    switch (prov) {
+    case LYRICSWIKIA:
+        res = fetch_lyrics_from_lyricswikia(artist, title, val, lyr);
+        break;
+    case LYRICSMANIA:
+        res = fetch_lyrics_from_lyricsmania(artist, title, val, lyr);
+        break;
+    case LYRICSTIME:
+        res = fetch_lyrics_from_lyricstime(artist, title, val, lyr);
+        break;
+    case MEGALYRICS:
+        res = fetch_lyrics_from_megalyrics(artist, title, val, lyr);
+        break;
+    case LYRICS_SCRIPT:
+        res = fetch_lyrics_from_script(artist, title, album, lyr);
+        break;
+    default:
+        break;
+    }
+    span_end(span, provider_name(prov), SPAN_PROVIDER);
+    if (res == FETCH_REJECTED)
+        return -1;
+
+    /* Confirmation, that the cached lyrics are still valid, is a hit too. */
+    int found = res == 0 || val->not_modified;
+    stats_attempt(prov, begin, found);
+    ranking_update(prov, (stats_now() - begin) / 1000, found);
+    return res;
+}
+
+/* Loads lyrics for the specified track from the cache. Misses aren't
+ * recorded, as they are followed by the full lookup. */
+int lookup_cached_lyrics(const char *artist, const char *title, char **lyr) {
+
+    char *txt_cache = NULL;
+    if (create_lyr_cache(artist, title, &txt_cache) == -1)
+        return -1;
+
+    int res = -1;
+    if (is_exists(txt_cache) && !is_old_cache(txt_cache, LYRICS))
+        res = load_txt_file(txt_cache, lyr);
+
+    if (res == 0)
+        stats_cache(LYRICS, CACHE_HIT);
+
+    free(txt_cache);
+    return res;
+}
+
+/* Loads biography and image of the specified artist from the cache. Both
+ * have to be fresh, otherwise the full lookup would fetch the image anyway. */
+int lookup_cached_bio(const char *artist, ImgSize size, char **bio, char **img_file) {
+
+    char *txt_cache = NULL, *img_cache = NULL;
+    if (create_bio_cache(artist, size, &txt_cache, &img_cache) == -1)
+        return -1;
+
+    int res = -1;
+    if (is_exists(txt_cache) && !is_old_cache(txt_cache, BIO) &&
+        is_exists(img_cache) && !is_old_cache(img_cache, BIO))
+    {
+        res = load_txt_file(txt_cache, bio);
+    }
+    free(txt_cache);
+
+    if (res == -1) {
+        free(img_cache);
+        return -1;
+    }
+    stats_cache(BIO, CACHE_HIT);
+    *img_file = img_cache;
+    return 0;
+}
+
+/* Retrieves lyrics for the specified track. */
+int lookup_track_lyrics(const char *artist, const char *title, const char *album, char **lyr) {
+
+    char *txt_cache = NULL;
+    if (create_lyr_cache(artist, title, &txt_cache) == -1)
+        return -1;
+
+    char *lyr_txt = NULL;
+    CacheState state = check_cache(txt_cache, LYRICS);
+    if (state != CACHE_HIT) {
+        /* There is no cache for the current track or the previous cache
+         * is too old, so start retrieving new one. */
+        Provider order[RANKED_PROVIDERS] = {0};
+        memcpy(order, lyrics_providers, sizeof(order));
+
+        /* Trying the sources, which are expected to give lyrics sooner, first. */
+        if (deadbeef->conf_get_int(CONF_LYRICS_ADAPTIVE, 1))
+            ranking_sort(order, RANKED_PROVIDERS);
+
+        /* Old lyrics are revalidated with the source they came from, before
+         * trying the others, as it's the cheapest way to refresh them. */
+        Validators val = {0};
+        if (state == CACHE_STALE && load_validators(txt_cache, &val) == 0)
+            move_to_front(order, RANKED_PROVIDERS, val.prov);
+
+        Provider source = LYRICS_SCRIPT;
+        for (int i = 0; i < RANKED_PROVIDERS && !lyr_txt && !val.not_modified; ++i) {
+            if (deadbeef->conf_get_int(lyrics_providers_conf[order[i]], 1) &&
+                fetch_lyrics(order[i], artist, title, album, &val, &lyr_txt) == 0)
+            {
+                source = order[i];
+            }
+        }
+
+        /* External script is always the last resort. */
+        if (deadbeef->conf_get_int(CONF_LYRICS_SCRIPT_ENABLED, 0) && !lyr_txt && !val.not_modified)
+            fetch_lyrics(LYRICS_SCRIPT, artist, title, album, &val, &lyr_txt);
+
+        ranking_save();
+
+        if (val.not_modified) {
+            /* Lyrics haven't changed, so they are just marked as fresh. */
+            touch_cache(txt_cache);
+            load_txt_file(txt_cache, &lyr_txt);
+        } else if (lyr_txt) {
+            char *lyr_wo_nl = NULL;
+            /* Some lyrics contains new line characters at the
+             * beginning of the text, so we gonna strip them. */
+            if (del_nl(lyr_txt, &lyr_wo_nl) == 0) {
+                free(lyr_txt);
+                lyr_txt = lyr_wo_nl;
+            }
+            ensure_utf8(&lyr_txt);
+
+            /* Saving lyrics to reuse it later.*/
+            save_txt_file(txt_cache, lyr_txt);
+
+            /* Validators could be left by the sources, which failed to give
+             * lyrics after all, they can't be used to revalidate these ones. */
+            if (val.prov != source)
+                free_validators(&val);
+            save_validators(txt_cache, &val);
+        }
+        free_validators(&val);
+    } else {
+        /* We got a cache for the current track, so just loading it. */
+        load_txt_file(txt_cache, &lyr_txt);
+    }
+    free(txt_cache);
+
+    *lyr = lyr_txt;
+    return lyr_txt ? 0 : -1;
+}
+
+/* Retrieves biography and image of the specified artist. */
+int lookup_artist_bio(const char *artist, ImgSize size, char **bio, char **img_file, ImgSink *sink) {
+
+    char *txt_cache = NULL, *img_cache = NULL;
+    if (create_bio_cache(artist, size, &txt_cache, &img_cache) == -1)
+        return -1;
+
+    char *bio_txt = NULL;
+    CacheState state = check_cache(txt_cache, BIO);
+    if (state != CACHE_HIT) {
+        /* There is no cache for artist's biography or it's
+         * too old, retrieving new one. */
+        Validators val = {0};
+        if (state == CACHE_STALE)
+            load_validators(txt_cache, &val);
+
+        uint64_t span = span_begin();
+        uint64_t begin = stats_now();
+        int res = fetch_bio_txt(artist, &val, &bio_txt);
+        if (res != FETCH_REJECTED)
+            stats_attempt(LASTFM_BIO, begin, res == 0 || val.not_modified);
+        span_end(span, "lastfm bio", SPAN_PROVIDER);
+
+        if (val.not_modified) {
+            /* Biography hasn't changed, so it's just marked as fresh. The
+             * image is taken from the same page, so it's still valid too. */
+            touch_cache(txt_cache);
+            if (is_exists(img_cache))
+                touch_cache(img_cache);
+            load_txt_file(txt_cache, &bio_txt);
+        } else if (res == 0) {
+            ensure_utf8(&bio_txt);
+
+            /* Saving biography to reuse it later. */
+            save_txt_file(txt_cache, bio_txt);
+            save_validators(txt_cache, &val);
+        }
+        free_validators(&val);
+    } else {
+        /* We got a cached biography, just loading it. */
+        load_txt_file(txt_cache, &bio_txt);
+    }
+    free(txt_cache);
+
+    /* Retrieving artist's image if we don't have a cached one. */
+    if (!is_exists(img_cache) || is_old_cache(img_cache, BIO)) {
+        uint64_t span = span_begin();
+        uint64_t begin = stats_now();
+        int res = fetch_bio_image(artist, size, img_cache, sink);
+        if (res != FETCH_REJECTED)
+            stats_attempt(LASTFM_IMAGE, begin, res == 0);
+        span_end(span, "lastfm image", SPAN_PROVIDER);
+    }
+
+    *bio = bio_txt;
+    *img_file = img_cache;
+    return 0;
+}
+
+/* Retrieves the list of similar artists from lastfm. */
+int lookup_similar_artists(const char *artist, SimilarInfo **similar, size_t *size) {
+
+    uint64_t span = span_begin();
+    uint64_t begin = stats_now();
+    int res = fetch_similar_artists(artist, similar, size);
+    if (res != FETCH_REJECTED)
+        stats_attempt(LASTFM_SIMILAR, begin, res == 0);
+    span_end(span, "lastfm similar", SPAN_PROVIDER);
+    return res == FETCH_REJECTED ? -1 : res;
+}
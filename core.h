@@ -0,0 +1,103 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_CORE_HEADER
+#define INFOBAR_CORE_HEADER
+
+/* Core part of the plug-in: fetching, parsing and caching. It doesn't
+ * depend on GTK+, so it's built once and shared by both GTK+ versions
+ * of the plug-in and the command line tool. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <deadbeef/deadbeef.h>
+
+#include "types.h"
+#include "spans.h"
+#include "stats.h"
+
+//#define trace(...) { fprintf(stderr, __VA_ARGS__); }
+#define trace(fmt, ...)
+
+/* Predefined names of infobar properties. */
+#define CONF_LYRICS_ENABLED "infobar.lyrics.enabled"
+#define CONF_LYRICSWIKIA_ENABLED "infobar.lyrics.lyricswikia"
+#define CONF_LYRICSMANIA_ENABLED "infobar.lyrics.lyricsmania"
+#define CONF_LYRICSTIME_ENABLED "infobar.lyrics.lyricstime"
+#define CONF_MEGALYRICS_ENABLED "infobar.lyrics.megalyrics"
+#define CONF_LYRICS_SCRIPT_ENABLED "infobar.lyrics.script"
+#define CONF_LYRICS_ADAPTIVE "infobar.lyrics.adaptive"
+#define CONF_LYRICS_ALIGNMENT "infobar.lyrics.alignment"
+#define CONF_BIO_ENABLED "infobar.bio.enabled"
+#define CONF_BIO_LOCALE "infobar.bio.locale"
+#define CONF_LYRICS_SCRIPT_PATH "infobar.lyrics.script.path"
+#define CONF_LYRICS_UPDATE_PERIOD "infobar.lyrics.cache.period"
+#define CONF_BIO_UPDATE_PERIOD "infobar.bio.cache.period"
+#define CONF_BIO_IMAGE_MEMORY "infobar.bio.image.memory"
+#define CONF_SIM_ENABLED "infobar.similar.enabled"
+#define CONF_SIM_MAX_ARTISTS "infobar.similar.max.artists"
+#define CONF_TRACE_ENABLED "infobar.trace.enabled"
+#define CONF_TRACE_FILE "infobar.trace.file"
+#define CONF_TRACE_STATS_PERIOD "infobar.trace.stats.period"
+#define CONF_CONNECT_TIMEOUT "infobar.%s.timeout.connect"
+#define CONF_READ_TIMEOUT "infobar.%s.timeout.read"
+#define CONF_BREAKER_THRESHOLD "infobar.breaker.threshold"
+#define CONF_BREAKER_BACKOFF "infobar.breaker.backoff"
+#define CONF_BREAKER_STATE "infobar.breaker.state"
+#define CONF_FETCH_DELAY "infobar.fetch.delay"
+#define CONF_FETCH_IDLE "infobar.fetch.idle"
+#define CONF_HTTP_ENABLED "infobar.http.enabled"
+#define CONF_HTTP_MAX_CONNECTIONS "infobar.http.max.connections"
+#define CONF_STATS_ENABLED "infobar.stats.enabled"
+#define CONF_STATS_FILE "infobar.stats.file"
+
+/* deadbeef API. Set by the plug-in loader or by the host of the
+ * command line tool. */
+extern DB_functions_t *deadbeef;
+
+/* Retrieves lyrics for the specified track. Cached lyrics are used if they
+ * are fresh enough, otherwise lyrics are fetched from the enabled sources
+ * and cached. Returns -1 if lyrics can't be found. */
+int lookup_track_lyrics(const char *artist, const char *title, const char *album, char **lyr);
+
+/* Loads lyrics for the specified track from the cache, without fetching
+ * them. Returns -1 if there are no fresh cached lyrics. */
+int lookup_cached_lyrics(const char *artist, const char *title, char **lyr);
+
+/* Loads biography and image of the specified artist and size from the cache,
+ * without fetching them. Returns -1 if there are no fresh cached ones. */
+int lookup_cached_bio(const char *artist, ImgSize size, char **bio, char **img_file);
+
+/* Retrieves biography and image of the specified artist and size. Cached ones are used
+ * if they are fresh enough, otherwise they are fetched from lastfm and cached.
+ * Path to the image cache file is always returned, even if there is no image.
+ * Biography is set to NULL if it can't be found. Returns -1 if cache files
+ * can't be created.
+ *
+ * If the image is downloaded, it's also passed to the sink as it arrives,
+ * so it can be decoded without reading the cache file back. */
+int lookup_artist_bio(const char *artist, ImgSize size, char **bio, char **img_file, ImgSink *sink);
+
+/* Retrieves the list of similar artists from lastfm. Returns -1 if
+ * the list can't be retrieved. */
+int lookup_similar_artists(const char *artist, SimilarInfo **similar, size_t *size);
+
+#endif
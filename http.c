@@ -0,0 +1,451 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "http.h"
+#include "core.h"
+#include "watchdog.h"
+
+#ifdef USE_CURL
+
+#include <strings.h>
+#include <pthread.h>
+#include <curl/curl.h>
+
+/* Request waiting to be processed by the fetch thread. */
+typedef struct Transfer {
+    CURL *curl;
+    CURLcode code;
+    long status;
+    int done;
+    /* Body received by the fetch thread, but not passed to the writer yet. */
+    char *body;
+    size_t body_len;
+    size_t body_size;
+    char *etag;
+    char *last_modified;
+    struct Transfer *next;
+} Transfer;
+
+static CURLM *multi;
+static pthread_t thread;
+static int started;
+static int stopped;
+/* Set by http_shutdown(), so late requests fail instead of starting
+ * the fetch thread again. */
+static int shut_down;
+static long max_host_connections;
+
+static Transfer *pending;
+static Transfer *active;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+/* Queues the received body for the caller, so the writer's work,
+ * like decoding images, doesn't hold up the other transfers. */
+static size_t
+write_body(char *ptr, size_t size, size_t nmemb, void *ctx) {
+
+    Transfer *transfer = ctx;
+    size_t len = size * nmemb;
+
+    pthread_mutex_lock(&mutex);
+    if (transfer->body_len + len > transfer->body_size) {
+        size_t body_size = transfer->body_size ? transfer->body_size : CURL_MAX_WRITE_SIZE;
+        while (body_size < transfer->body_len + len)
+            body_size *= 2;
+
+        char *body = realloc(transfer->body, body_size);
+        if (!body) {
+            pthread_mutex_unlock(&mutex);
+            return 0;
+        }
+        transfer->body = body;
+        transfer->body_size = body_size;
+    }
+    memcpy(transfer->body + transfer->body_len, ptr, len);
+    transfer->body_len += len;
+    pthread_cond_broadcast(&done_cond);
+    pthread_mutex_unlock(&mutex);
+    return len;
+}
+
+/* Returns copy of the header's value, if the header line has the specified name. */
+static char *
+header_value(const char *line, size_t len, const char *name) {
+
+    size_t name_len = strlen(name);
+    if (len <= name_len || strncasecmp(line, name, name_len) != 0 || line[name_len] != ':')
+        return NULL;
+
+    const char *beg = line + name_len + 1, *end = line + len;
+    while (beg < end && (*beg == ' ' || *beg == '\t'))
+        ++beg;
+    while (end > beg && (end[-1] == '\r' || end[-1] == '\n' || end[-1] == ' '))
+        --end;
+
+    return beg < end ? strndup(beg, end - beg) : NULL;
+}
+
+/* Picks up the response's validators. Headers of every response are passed
+ * here, including redirects, so only the last ones are kept. */
+static size_t
+read_header(char *ptr, size_t size, size_t nmemb, void *ctx) {
+
+    Transfer *transfer = ctx;
+    size_t len = size * nmemb;
+
+    char *value = NULL;
+    if (len > 5 && strncmp(ptr, "HTTP/", 5) == 0) {
+        free(transfer->etag);
+        free(transfer->last_modified);
+        transfer->etag = transfer->last_modified = NULL;
+    } else if ((value = header_value(ptr, len, "ETag"))) {
+        free(transfer->etag);
+        transfer->etag = value;
+    } else if ((value = header_value(ptr, len, "Last-Modified"))) {
+        free(transfer->last_modified);
+        transfer->last_modified = value;
+    }
+    return len;
+}
+
+/* Adds conditional headers, if the validators belong to the same URL. */
+static struct curl_slist *
+add_conditions(CURL *curl, const char *url, const Validators *val) {
+
+    if (!val || !val->url || strcmp(val->url, url) != 0)
+        return NULL;
+
+    char *header = NULL;
+    struct curl_slist *headers = NULL;
+    if (val->etag && asprintf(&header, "If-None-Match: %s", val->etag) != -1) {
+        headers = curl_slist_append(headers, header);
+        free(header);
+    }
+    if (val->last_modified && asprintf(&header, "If-Modified-Since: %s", val->last_modified) != -1) {
+        headers = curl_slist_append(headers, header);
+        free(header);
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    return headers;
+}
+
+/* Updates validators with the outcome of the successful request. */
+static void
+update_validators(Validators *val, const char *url, Provider prov, Transfer *transfer) {
+
+    if (transfer->status == 304) {
+        val->not_modified = 1;
+        return;
+    }
+
+    free(val->url);
+    free(val->etag);
+    free(val->last_modified);
+
+    val->prov = prov;
+    val->url = strdup(url);
+    val->etag = transfer->etag;
+    val->last_modified = transfer->last_modified;
+    transfer->etag = transfer->last_modified = NULL;
+}
+
+/* Marks transfer as done and wakes up its caller. Should be called
+ * with the mutex held. */
+static void
+finish_transfer(Transfer *transfer, CURLcode code) {
+
+    for (Transfer **it = &active; *it; it = &(*it)->next) {
+        if (*it == transfer) {
+            *it = transfer->next;
+            break;
+        }
+    }
+
+    transfer->code = code;
+    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &transfer->status);
+    transfer->done = 1;
+    pthread_cond_broadcast(&done_cond);
+}
+
+/* Runs all transfers on the single multi handle, so connections
+ * to the same host are reused. */
+static void *
+run_transfers(void *ctx) {
+
+    int running = 0;
+    long host_connections = 0;
+
+    pthread_mutex_lock(&mutex);
+    while (!stopped) {
+        /* Picking up new requests. */
+        while (pending) {
+            Transfer *transfer = pending;
+            pending = transfer->next;
+            transfer->next = active;
+            active = transfer;
+            if (curl_multi_add_handle(multi, transfer->curl) != CURLM_OK)
+                finish_transfer(transfer, CURLE_FAILED_INIT);
+        }
+        if (host_connections != max_host_connections) {
+            host_connections = max_host_connections;
+            curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, host_connections);
+        }
+        pthread_mutex_unlock(&mutex);
+
+        curl_multi_perform(multi, &running);
+
+        CURLMsg *msg = NULL;
+        int left = 0;
+        while ((msg = curl_multi_info_read(multi, &left))) {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            Transfer *transfer = NULL;
+            CURLcode code = msg->data.result;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**) &transfer);
+            curl_multi_remove_handle(multi, msg->easy_handle);
+
+            pthread_mutex_lock(&mutex);
+            finish_transfer(transfer, code);
+            pthread_mutex_unlock(&mutex);
+        }
+
+        curl_multi_poll(multi, NULL, 0, 1000, NULL);
+        pthread_mutex_lock(&mutex);
+    }
+
+    /* Failing requests, which weren't finished. */
+    while (active) {
+        curl_multi_remove_handle(multi, active->curl);
+        finish_transfer(active, CURLE_ABORTED_BY_CALLBACK);
+    }
+    while (pending) {
+        Transfer *transfer = pending;
+        pending = transfer->next;
+        finish_transfer(transfer, CURLE_ABORTED_BY_CALLBACK);
+    }
+    pthread_mutex_unlock(&mutex);
+    return NULL;
+}
+
+/* Starts the fetch thread. Should be called with the mutex held. */
+static int
+start_fetching(void) {
+
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK)
+        return -1;
+
+    multi = curl_multi_init();
+    if (!multi) {
+        curl_global_cleanup();
+        return -1;
+    }
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, (long) HTTP_MAX_IDLE_CONNECTIONS);
+
+    stopped = 0;
+    if (pthread_create(&thread, NULL, run_transfers, NULL) != 0) {
+        curl_multi_cleanup(multi);
+        curl_global_cleanup();
+        multi = NULL;
+        return -1;
+    }
+    started = 1;
+    return 0;
+}
+
+/* Applies player's proxy settings, like its own HTTP streams do. */
+static void
+set_proxy(CURL *curl) {
+
+    if (!deadbeef->conf_get_int("network.proxy", 0))
+        return;
+
+    deadbeef->conf_lock();
+    curl_easy_setopt(curl, CURLOPT_PROXY, deadbeef->conf_get_str_fast("network.proxy.address", ""));
+    curl_easy_setopt(curl, CURLOPT_PROXYPORT, (long) deadbeef->conf_get_int("network.proxy.port", 8080));
+
+    const char *type = deadbeef->conf_get_str_fast("network.proxy.type", "HTTP");
+    long curl_type = CURLPROXY_HTTP;
+    if (strcasecmp(type, "HTTP_1_0") == 0)
+        curl_type = CURLPROXY_HTTP_1_0;
+    else if (strcasecmp(type, "SOCKS4") == 0)
+        curl_type = CURLPROXY_SOCKS4;
+    else if (strcasecmp(type, "SOCKS5") == 0)
+        curl_type = CURLPROXY_SOCKS5;
+    else if (strcasecmp(type, "SOCKS4A") == 0)
+        curl_type = CURLPROXY_SOCKS4A;
+    else if (strcasecmp(type, "SOCKS5_HOSTNAME") == 0)
+        curl_type = CURLPROXY_SOCKS5_HOSTNAME;
+    curl_easy_setopt(curl, CURLOPT_PROXYTYPE, curl_type);
+
+    const char *user = deadbeef->conf_get_str_fast("network.proxy.username", "");
+    const char *pass = deadbeef->conf_get_str_fast("network.proxy.password", "");
+    if (*user) {
+        curl_easy_setopt(curl, CURLOPT_PROXYUSERNAME, user);
+        curl_easy_setopt(curl, CURLOPT_PROXYPASSWORD, pass);
+    }
+    deadbeef->conf_unlock();
+}
+
+/* Checks if the HTTP backend is built in and enabled. */
+int http_enabled(void) {
+    return deadbeef->conf_get_int(CONF_HTTP_ENABLED, 1);
+}
+
+/* Performs GET request through the shared connection pool. */
+int http_get(const char *url, Provider prov, Validators *val, HttpWriter writer, void *ctx, HttpResult *res) {
+
+    char key[64] = {0};
+    const char *site = provider_site(prov);
+
+    Transfer transfer = {0};
+    transfer.curl = curl_easy_init();
+    if (!transfer.curl)
+        return -1;
+
+    CURL *curl = transfer.curl;
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, &transfer);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "deadbeef");
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_body);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, read_header);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &transfer);
+    struct curl_slist *headers = add_conditions(curl, url, val);
+
+    /* Same deadlines as the watchdog applies to VFS streams: both start
+     * with the request, and the read deadline bounds the whole of it. */
+    snprintf(key, sizeof(key), CONF_CONNECT_TIMEOUT, site);
+    long connect_timeout = deadbeef->conf_get_int(key, DEF_CONNECT_TIMEOUT);
+
+    snprintf(key, sizeof(key), CONF_READ_TIMEOUT, site);
+    long read_timeout = deadbeef->conf_get_int(key, DEF_READ_TIMEOUT);
+
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, connect_timeout);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, read_timeout);
+
+    set_proxy(curl);
+
+    pthread_mutex_lock(&mutex);
+    if (shut_down || (started && stopped) || (!started && start_fetching() == -1)) {
+        pthread_mutex_unlock(&mutex);
+        curl_easy_cleanup(curl);
+        curl_slist_free_all(headers);
+        return -1;
+    }
+    max_host_connections = deadbeef->conf_get_int(CONF_HTTP_MAX_CONNECTIONS, DEF_MAX_HOST_CONNECTIONS);
+
+    transfer.next = pending;
+    pending = &transfer;
+    curl_multi_wakeup(multi);
+
+    /* Received body is passed to the writer on the caller's thread. */
+    while (!transfer.done || transfer.body_len > 0) {
+        if (transfer.body_len == 0) {
+            pthread_cond_wait(&done_cond, &mutex);
+            continue;
+        }
+        char *body = transfer.body;
+        size_t len = transfer.body_len;
+        transfer.body = NULL;
+        transfer.body_len = transfer.body_size = 0;
+        pthread_mutex_unlock(&mutex);
+
+        writer(body, len, ctx);
+        free(body);
+        pthread_mutex_lock(&mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+
+    curl_easy_cleanup(curl);
+    curl_slist_free_all(headers);
+
+    if (val && transfer.code == CURLE_OK)
+        update_validators(val, url, prov, &transfer);
+
+    free(transfer.etag);
+    free(transfer.last_modified);
+
+    res->status = transfer.status;
+    res->timed_out = transfer.code == CURLE_OPERATION_TIMEDOUT;
+    trace("infobar: %s: %s\n", url, curl_easy_strerror(transfer.code));
+    return transfer.code == CURLE_OK ? 0 : -1;
+}
+
+/* Allows requests again after the shutdown. */
+void http_init(void) {
+
+    pthread_mutex_lock(&mutex);
+    shut_down = 0;
+    pthread_mutex_unlock(&mutex);
+}
+
+/* Stops the fetch thread and closes all connections. */
+void http_shutdown(void) {
+
+    pthread_mutex_lock(&mutex);
+    shut_down = 1;
+    if (!started) {
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
+    stopped = 1;
+    curl_multi_wakeup(multi);
+    pthread_mutex_unlock(&mutex);
+
+    pthread_join(thread, NULL);
+
+    pthread_mutex_lock(&mutex);
+    while (pending) {
+        Transfer *transfer = pending;
+        pending = transfer->next;
+        finish_transfer(transfer, CURLE_ABORTED_BY_CALLBACK);
+    }
+    curl_multi_cleanup(multi);
+    curl_global_cleanup();
+    multi = NULL;
+    started = 0;
+    pthread_mutex_unlock(&mutex);
+}
+
+#else
+
+/* Checks if the HTTP backend is built in and enabled. */
+int http_enabled(void) {
+    return 0;
+}
+
+/* HTTP backend isn't built in. */
+int http_get(const char *url, Provider prov, Validators *val, HttpWriter writer, void *ctx, HttpResult *res) {
+    return -1;
+}
+
+/* HTTP backend isn't built in. */
+void http_init(void) {}
+
+/* HTTP backend isn't built in. */
+void http_shutdown(void) {}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_HTTP_HEADER
+#define INFOBAR_HTTP_HEADER
+
+#include <stddef.h>
+
+#include "types.h"
+
+/* Default maximum number of simultaneous connections to a single host. */
+#define DEF_MAX_HOST_CONNECTIONS 2
+
+/* Maximum number of idle connections kept open for reuse. */
+#define HTTP_MAX_IDLE_CONNECTIONS 8
+
+/* Receives the next piece of the response body. */
+typedef void (*HttpWriter)(const char *data, size_t size, void *ctx);
+
+/* Outcome of the request. Status is 0, if no response was received. */
+typedef struct {
+    long status;
+    int timed_out;
+} HttpResult;
+
+/* Checks if the HTTP backend is built in and enabled. Otherwise
+ * content is fetched through deadbeef's VFS. */
+int http_enabled(void);
+
+/* Performs GET request through the shared connection pool, passing the
+ * response body to the writer as it arrives. The fetch thread only queues
+ * the body, and the writer is called on the caller's thread. Returns -1
+ * if the request failed or timed out.
+ *
+ * If validators are specified and were received for the same URL, the
+ * request is conditional, and "304 Not Modified" response sets their
+ * not_modified flag. Otherwise they are replaced by the validators of
+ * the successful response. */
+int http_get(const char *url, Provider prov, Validators *val, HttpWriter writer, void *ctx, HttpResult *res);
+
+/* Allows requests again after the shutdown. The fetch thread itself
+ * is started by the first request. */
+void http_init(void);
+
+/* Stops the fetch thread and closes all connections. Requests made
+ * after the shutdown fail until http_init() is called. */
+void http_shutdown(void);
+
+#endif
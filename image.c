@@ -0,0 +1,359 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "image.h"
+#include "spans.h"
+#include "utils.h"
+
+/* Decoded image, shared by the cache and the view. It's never changed
+ * after decoding, so it's used without locking. */
+typedef struct ImgEntry {
+    char *file;
+    int width;
+    int height;
+    time_t mtime;
+    GdkPixbuf *img;
+    size_t bytes;
+    struct ImgEntry *prev;
+    struct ImgEntry *next;
+} ImgEntry;
+
+/* Recently decoded images, the most recent first. */
+static ImgEntry *lru_head;
+static ImgEntry *lru_tail;
+static size_t lru_bytes;
+static pthread_mutex_t lru_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+lru_unlink(ImgEntry *entry) {
+
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        lru_head = entry->next;
+
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        lru_tail = entry->prev;
+
+    entry->prev = entry->next = NULL;
+    lru_bytes -= entry->bytes;
+}
+
+static void
+lru_push_front(ImgEntry *entry) {
+
+    entry->next = lru_head;
+    if (lru_head)
+        lru_head->prev = entry;
+    else
+        lru_tail = entry;
+
+    lru_head = entry;
+    lru_bytes += entry->bytes;
+}
+
+static void
+free_entry(ImgEntry *entry) {
+
+    g_object_unref(entry->img);
+    free(entry->file);
+    free(entry);
+}
+
+/* Finds the image decoded from the file for the specified size. Should
+ * be called with the mutex held. */
+static ImgEntry *
+lru_find(const char *file, int width, int height) {
+
+    for (ImgEntry *entry = lru_head; entry; entry = entry->next) {
+        if (entry->width == width && entry->height == height && strcmp(entry->file, file) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+/* Returns the recently decoded image, unless the file was changed since. */
+static GdkPixbuf *
+lru_get(const char *file, int width, int height, time_t mtime) {
+
+    GdkPixbuf *img = NULL;
+
+    pthread_mutex_lock(&lru_mutex);
+    ImgEntry *entry = lru_find(file, width, height);
+    if (entry) {
+        lru_unlink(entry);
+        if (entry->mtime == mtime) {
+            lru_push_front(entry);
+            img = g_object_ref(entry->img);
+        } else {
+            free_entry(entry);
+        }
+    }
+    pthread_mutex_unlock(&lru_mutex);
+    return img;
+}
+
+/* Adds the image, evicting the least recently used ones, so all
+ * images fit into the configured memory. Image, which doesn't fit
+ * at all, isn't added, but the budget is still enforced, as it may
+ * have been lowered. */
+static void
+lru_put(const char *file, int width, int height, time_t mtime, GdkPixbuf *img) {
+
+    size_t budget = (size_t) deadbeef->conf_get_int(CONF_BIO_IMAGE_MEMORY, DEF_IMG_MEMORY) << 20;
+    size_t bytes = (size_t) gdk_pixbuf_get_rowstride(img) * gdk_pixbuf_get_height(img);
+
+    ImgEntry *entry = NULL;
+    if (bytes <= budget) {
+        entry = calloc(1, sizeof(ImgEntry));
+        if (entry && !(entry->file = strdup(file))) {
+            free(entry);
+            entry = NULL;
+        }
+    }
+    if (entry) {
+        entry->width = width;
+        entry->height = height;
+        entry->mtime = mtime;
+        entry->img = g_object_ref(img);
+        entry->bytes = bytes;
+    }
+
+    pthread_mutex_lock(&lru_mutex);
+    ImgEntry *old = lru_find(file, width, height);
+    if (old) {
+        lru_unlink(old);
+        free_entry(old);
+    }
+    size_t needed = entry ? bytes : 0;
+    while (lru_tail && lru_bytes + needed > budget) {
+        ImgEntry *last = lru_tail;
+        lru_unlink(last);
+        free_entry(last);
+    }
+    if (entry)
+        lru_push_front(entry);
+    pthread_mutex_unlock(&lru_mutex);
+}
+
+/* Returns modification time of the file or 0, if it doesn't exist. */
+static time_t
+get_mtime(const char *file) {
+
+    struct stat st;
+    return stat(file, &st) == 0 ? st.st_mtime : 0;
+}
+
+/* Keeps the image decoded from the file for the specified size. */
+void remember_bio_image(const char *file, int width, int height, GdkPixbuf *img) {
+
+    time_t mtime = get_mtime(file);
+    if (mtime)
+        lru_put(file, width, height, mtime, img);
+}
+
+/* Releases all recently decoded images. */
+void forget_bio_images(void) {
+
+    pthread_mutex_lock(&lru_mutex);
+    while (lru_head) {
+        ImgEntry *entry = lru_head;
+        lru_unlink(entry);
+        free_entry(entry);
+    }
+    pthread_mutex_unlock(&lru_mutex);
+}
+
+/* Checks if the thumbnail was made after the image was saved. */
+static gboolean
+is_fresh_thumb(const char *file, const char *thumb) {
+
+    struct stat img_st, thumb_st;
+    if (stat(file, &img_st) != 0 || stat(thumb, &thumb_st) != 0)
+        return FALSE;
+
+    return thumb_st.st_mtime >= img_st.st_mtime;
+}
+
+/* Decodes the original image to fit the square of the specified size
+ * and saves it as the thumbnail. Returns the decoded thumbnail. */
+static GdkPixbuf *
+make_thumb(const char *file, const char *thumb, int size) {
+
+    GdkPixbuf *img = gdk_pixbuf_new_from_file_at_size(file, size, size, NULL);
+    if (!img)
+        return NULL;
+
+    /* Thumbnail is written to the temporary file first, so the
+     * partially written one is never decoded. */
+    char *tmp = NULL;
+    if (asprintf(&tmp, "%s.tmp", thumb) != -1) {
+        if (gdk_pixbuf_save(img, tmp, "png", NULL, NULL))
+            rename(tmp, thumb);
+        else
+            remove(tmp);
+        free(tmp);
+    }
+    return img;
+}
+
+/* Decodes the image to fit the specified size, using the thumbnail of
+ * the closest larger size. The thumbnail is made, if there is no one. */
+static GdkPixbuf *
+load_thumb(const char *file, int size, int width, int height) {
+
+    char *thumb = NULL;
+    if (form_thumb_path(file, size, &thumb) == -1)
+        return NULL;
+
+    GdkPixbuf *img = NULL;
+    if (is_fresh_thumb(file, thumb))
+        img = gdk_pixbuf_new_from_file_at_size(thumb, width, height, NULL);
+
+    if (!img) {
+        GdkPixbuf *sld = make_thumb(file, thumb, size);
+        if (sld) {
+            img = gdk_pixbuf_scale_simple(sld, width, height, GDK_INTERP_BILINEAR);
+            g_object_unref(sld);
+        }
+    }
+    free(thumb);
+    return img;
+}
+
+/* Decodes artist's image from the file, scaling it down to fit the specified size. */
+GdkPixbuf *load_bio_image(const char *file, int width, int height) {
+
+    time_t mtime = get_mtime(file);
+    if (!mtime)
+        return NULL;
+
+    GdkPixbuf *img = lru_get(file, width, height, mtime);
+    if (img)
+        return img;
+
+    int ww = 0, wh = 0;
+    if (!gdk_pixbuf_get_file_info(file, &ww, &wh))
+        return NULL;
+
+    uint64_t span = span_begin();
+    if (width > 0 && height > 0) {
+        /* Image is decoded straight to the size, it's going to be shown at,
+         * so the GUI thread doesn't have to scale it again. */
+        Res res = {0};
+        find_new_resolution(ww, wh, width, height, &res);
+
+        int max_side = res.width > res.height ? res.width : res.height;
+        int size = (max_side + THUMB_SIZE_STEP - 1) / THUMB_SIZE_STEP * THUMB_SIZE_STEP;
+
+        /* Large originals are decoded from the much smaller thumbnail. */
+        if (size <= THUMB_MAX_SIZE && (size < ww || size < wh))
+            img = load_thumb(file, size, res.width, res.height);
+
+        if (!img)
+            img = gdk_pixbuf_new_from_file_at_size(file, res.width, res.height, NULL);
+    } else {
+        img = gdk_pixbuf_new_from_file(file, NULL);
+    }
+    span_end(span, "image", SPAN_PARSE);
+
+    if (img)
+        lru_put(file, width, height, mtime, img);
+
+    return img;
+}
+
+/* Called when the loader knows the size of the image. */
+static void
+img_size_prepared(GdkPixbufLoader *loader, int ww, int wh, gpointer data) {
+
+    ImgStream *stream = data;
+    if (stream->width > 0 && stream->height > 0) {
+        Res res = {0};
+        find_new_resolution(ww, wh, stream->width, stream->height, &res);
+        if (res.width >= 1 && res.height >= 1)
+            gdk_pixbuf_loader_set_size(loader, res.width, res.height);
+    }
+}
+
+/* Prepares the stream to decode the image. */
+void img_stream_init(ImgStream *stream, int width, int height, ImgProgress progress, void *ctx) {
+
+    memset(stream, 0, sizeof(ImgStream));
+    stream->width = width;
+    stream->height = height;
+    stream->progress = progress;
+    stream->ctx = ctx;
+    stream->last_progress = g_get_monotonic_time();
+}
+
+/* Decodes the next piece of the image. */
+void img_stream_write(const char *data, size_t size, void *ctx) {
+
+    ImgStream *stream = ctx;
+    if (stream->failed)
+        return;
+
+    /* Loader is created only when the image is actually downloaded. */
+    if (!stream->loader) {
+        stream->loader = gdk_pixbuf_loader_new();
+        g_signal_connect(stream->loader, "size-prepared", G_CALLBACK(img_size_prepared), stream);
+    }
+
+    if (!gdk_pixbuf_loader_write(stream->loader, (const guchar*) data, size, NULL)) {
+        stream->failed = 1;
+        return;
+    }
+
+    if (stream->progress) {
+        gint64 now = g_get_monotonic_time();
+        if (now - stream->last_progress >= IMG_PROGRESS_INTERVAL * 1000) {
+            /* Loader keeps decoding into its pixbuf, so the copy is passed. */
+            GdkPixbuf *img = gdk_pixbuf_loader_get_pixbuf(stream->loader);
+            GdkPixbuf *copy = img ? gdk_pixbuf_copy(img) : NULL;
+            if (copy) {
+                stream->last_progress = now;
+                stream->progress(copy, stream->ctx);
+            }
+        }
+    }
+}
+
+/* Finishes decoding and releases the stream. */
+GdkPixbuf *img_stream_finish(ImgStream *stream) {
+
+    GdkPixbuf *img = NULL;
+    if (stream->loader) {
+        if (gdk_pixbuf_loader_close(stream->loader, NULL) && !stream->failed) {
+            img = gdk_pixbuf_loader_get_pixbuf(stream->loader);
+            if (img)
+                g_object_ref(img);
+        }
+        g_object_unref(stream->loader);
+        stream->loader = NULL;
+    }
+    return img;
+}
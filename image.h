@@ -0,0 +1,70 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_IMAGE_HEADER
+#define INFOBAR_IMAGE_HEADER
+
+#include <gtk/gtk.h>
+
+/* Minimal interval between the updates with partially downloaded image, in ms. */
+#define IMG_PROGRESS_INTERVAL 100
+
+/* Default memory for the recently decoded images, in MB. */
+#define DEF_IMG_MEMORY 16
+
+/* Receives the copy of partially decoded image, which is owned by the callee. */
+typedef void (*ImgProgress)(GdkPixbuf *img, void *ctx);
+
+/* Artist's image, which is decoded while it's being downloaded. */
+typedef struct {
+    GdkPixbufLoader *loader;
+    int width;
+    int height;
+    int failed;
+    gint64 last_progress;
+    ImgProgress progress;
+    void *ctx;
+} ImgStream;
+
+/* Decodes artist's image from the file, scaling it down to fit the
+ * specified size in device pixels. Image is decoded at its original
+ * size, if the size is unknown (0). Recently decoded images are reused,
+ * while they fit into CONF_BIO_IMAGE_MEMORY. Can be called from any
+ * thread. Returns NULL, if the image can't be decoded. */
+GdkPixbuf *load_bio_image(const char *file, int width, int height);
+
+/* Keeps the image decoded from the file for the specified size, so
+ * load_bio_image can reuse it. */
+void remember_bio_image(const char *file, int width, int height, GdkPixbuf *img);
+
+/* Releases all recently decoded images. */
+void forget_bio_images(void);
+
+/* Prepares the stream to decode the image, scaling it down to fit the
+ * specified size, as load_bio_image does. Progress callback is optional. */
+void img_stream_init(ImgStream *stream, int width, int height, ImgProgress progress, void *ctx);
+
+/* Decodes the next piece of the image, can be used as the ImgSink's writer. */
+void img_stream_write(const char *data, size_t size, void *ctx);
+
+/* Finishes decoding and releases the stream. Returns the decoded image
+ * or NULL, if nothing was received or the image is broken. */
+GdkPixbuf *img_stream_finish(ImgStream *stream);
+
+#endif
@@ -17,202 +17,609 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
 #include "infobar.h"
 
+/* UI plugin. */
+ddb_gtkui_t *gtkui_plugin;
+
+static intptr_t spans_tid;
+static int spans_stop;
+
+/* Content, which has to be fetched for the track. */
+typedef enum {
+    FETCH_LYRICS = 1 << 0,
+    FETCH_ARTIST = 1 << 1,
+    FETCH_ALL = FETCH_LYRICS | FETCH_ARTIST,
+} FetchMask;
+
+/* Fingerprint of the metadata, the content of the stream was last
+ * fetched for. Stations update track info often, mostly without
+ * changing the song. */
+typedef struct {
+    DB_playItem_t *track;
+    uint64_t artist;
+    uint64_t song;
+} StreamFingerprint;
+
+static StreamFingerprint stream_fp;
+
+/* Set when the plug-in is disconnected, so waiting workers give up. */
+static int fetch_stop;
+
+/* Generation of each view's content, bumped on every song change. Stations
+ * keep the same track for all songs, so the generation tells them apart:
+ * fetches and updates of the replaced songs are dropped. */
+static unsigned fetch_generation[VIEWS_COUNT];
+
+/* Fetch of the view's content for the song, owned by its worker. */
+typedef struct {
+    DB_playItem_t *track;
+    InfobarView view;
+    unsigned generation;
+} FetchJob;
+
+/* Priority, the fetch was started with. */
+typedef enum {
+    PRIORITY_BACKGROUND = 0,
+    PRIORITY_VISIBLE = 1,
+} FetchPriority;
+
+/* Number of running fetches for the visible view. Fetches for the hidden
+ * views wait for them, so they don't compete for bandwidth and CPU. */
+static int visible_fetches;
+static pthread_mutex_t fetch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t fetch_cond = PTHREAD_COND_INITIALIZER;
+
+/* Checks if the specified track is playing. Unlike is_track_changed(),
+ * stopped playback doesn't keep the track current. */
+static gboolean
+is_track_current(DB_playItem_t *track) {
+
+    DB_playItem_t *cur = deadbeef->streamer_get_playing_track();
+    if (cur)
+        deadbeef->pl_item_unref(cur);
+
+    return cur == track;
+}
+
+/* Checks if the view's content is still fetched for the song, which
+ * the job was started for. */
+static gboolean
+is_generation_current(InfobarView view, unsigned generation) {
+    return __atomic_load_n(&fetch_generation[view], __ATOMIC_RELAXED) == generation;
+}
+
+/* Checks if the song, the job was started for, was replaced. Like
+ * is_track_changed(), stopped playback doesn't replace it. */
+static gboolean
+is_job_stale(const FetchJob *job) {
+    return is_track_changed(job->track) || !is_generation_current(job->view, job->generation);
+}
+
+/* Waits until the content of the view is worth fetching: the track has
+ * stayed current for the configured delay, so nothing is fetched for the
+ * tracks, which are skipped quickly, and the view is shown to the user.
+ * Hidden views are fetched when they are switched to, or once the idle
+ * delay has passed, if it's set. Returns -1 if the song was changed
+ * or stopped meanwhile. */
+static int
+wait_for_fetch(const FetchJob *job) {
+
+    int delay = deadbeef->conf_get_int(CONF_FETCH_DELAY, DEF_FETCH_DELAY);
+    int idle = deadbeef->conf_get_int(CONF_FETCH_IDLE, 0) * 1000;
+    uint64_t begin = stats_now();
+
+    int res = -1;
+    pthread_mutex_lock(&fetch_mutex);
+    while (is_track_current(job->track) && is_generation_current(job->view, job->generation) &&
+           !__atomic_load_n(&fetch_stop, __ATOMIC_RELAXED))
+    {
+        int elapsed = (stats_now() - begin) / 1000000;
+        if (elapsed >= delay && (infobar_view_visible(job->view) || (idle > 0 && elapsed >= idle))) {
+            res = 0;
+            break;
+        }
+
+        /* Sleeping till the next deadline, track changes and view
+         * switches wake the fetch up earlier. */
+        int timeout = (elapsed < delay ? delay : idle) - elapsed;
+        if (timeout > 0) {
+            struct timespec ts = {0};
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += timeout / 1000;
+            ts.tv_nsec += (timeout % 1000) * 1000000L;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec += 1;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&fetch_cond, &fetch_mutex, &ts);
+        } else {
+            pthread_cond_wait(&fetch_cond, &fetch_mutex);
+        }
+    }
+    pthread_mutex_unlock(&fetch_mutex);
+    return res;
+}
+
+/* Starts the fetch for the view. Fetch for the visible view starts at once,
+ * while the fetch for the hidden one waits until the visible view's fetches
+ * are finished, or until its own view is switched to. Returns -1 if the
+ * song was changed meanwhile. */
+static int
+begin_fetch(const FetchJob *job, FetchPriority *prio) {
+
+    InfobarView view = job->view;
+    pthread_mutex_lock(&fetch_mutex);
+    while (!infobar_view_visible(view) && visible_fetches > 0) {
+        if (!is_track_current(job->track) || !is_generation_current(view, job->generation) ||
+            __atomic_load_n(&fetch_stop, __ATOMIC_RELAXED))
+        {
+            pthread_mutex_unlock(&fetch_mutex);
+            return -1;
+        }
+        pthread_cond_wait(&fetch_cond, &fetch_mutex);
+    }
+
+    *prio = infobar_view_visible(view) ? PRIORITY_VISIBLE : PRIORITY_BACKGROUND;
+    if (*prio == PRIORITY_VISIBLE)
+        ++visible_fetches;
+
+    pthread_mutex_unlock(&fetch_mutex);
+    return 0;
+}
+
+/* Finishes the fetch, letting the waiting ones start. */
+static void
+end_fetch(FetchPriority prio) {
+
+    pthread_mutex_lock(&fetch_mutex);
+    if (prio == PRIORITY_VISIBLE)
+        --visible_fetches;
+
+    pthread_cond_broadcast(&fetch_cond);
+    pthread_mutex_unlock(&fetch_mutex);
+}
+
+/* Wakes up the waiting fetches, so they check their track, view and
+ * priority again. */
+void infobar_reschedule_fetches(void) {
+
+    pthread_mutex_lock(&fetch_mutex);
+    pthread_cond_broadcast(&fetch_cond);
+    pthread_mutex_unlock(&fetch_mutex);
+}
+
+/* Content for the view, posted by the worker to the main loop.
+ * The update owns its content and isn't changed after posting. */
+typedef struct {
+    DB_playItem_t *track;
+    unsigned generation;
+    char *txt;
+    char *artist;
+    char *title;
+    GdkPixbuf *img;
+    SimilarInfo *similar;
+    size_t size;
+} ViewUpdate;
+
+/* The latest update of each view, which wasn't dispatched yet. Updates,
+ * which are replaced before the main loop gets to them, are never shown. */
+static ViewUpdate *pending_updates[VIEWS_COUNT];
+static guint dispatch_source;
+static pthread_mutex_t update_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *update_span_names[VIEWS_COUNT] = {
+    "lyrics view", "bio view", "similar view",
+};
+
+static void
+free_view_update(ViewUpdate *update) {
+
+    deadbeef->pl_item_unref(update->track);
+    free(update->txt);
+    free(update->artist);
+    free(update->title);
+    if (update->img)
+        g_object_unref(update->img);
+    if (update->similar)
+        free_sim_list(update->similar, update->size);
+
+    free(update);
+}
+
+/* Applies the pending updates on the main loop. Updates for the song,
+ * which isn't playing anymore, are dropped. */
+static gboolean
+dispatch_updates(gpointer data) {
+
+    ViewUpdate *updates[VIEWS_COUNT] = {0};
+
+    pthread_mutex_lock(&update_mutex);
+    memcpy(updates, pending_updates, sizeof(updates));
+    memset(pending_updates, 0, sizeof(pending_updates));
+    dispatch_source = 0;
+    pthread_mutex_unlock(&update_mutex);
+
+    for (int i = 0; i < VIEWS_COUNT; ++i) {
+
+        ViewUpdate *update = updates[i];
+        if (!update)
+            continue;
+
+        if (!is_track_changed(update->track) && is_generation_current(i, update->generation)) {
+            uint64_t span = span_begin();
+            switch (i) {
+            case VIEW_LYRICS:
+                update_lyrics_view(update->txt, update->artist, update->title);
+                break;
+            case VIEW_BIO:
+                update_bio_view(update->txt, update->img);
+                break;
+            case VIEW_SIMILAR:
+                update_similar_view(update->similar, update->size);
+                break;
+            }
+            span_end(span, update_span_names[i], SPAN_GUI);
+        }
+        free_view_update(update);
+    }
+    return FALSE;
+}
+
+/* Posts the update to the main loop, replacing the pending one. Workers
+ * never wait for the GUI. */
+static void
+post_update(InfobarView view, ViewUpdate *update) {
+
+    pthread_mutex_lock(&update_mutex);
+    ViewUpdate *replaced = pending_updates[view];
+    pending_updates[view] = update;
+    if (!dispatch_source)
+        dispatch_source = gdk_threads_add_idle(dispatch_updates, NULL);
+    pthread_mutex_unlock(&update_mutex);
+
+    if (replaced)
+        free_view_update(replaced);
+}
+
+/* Creates the update of the job's view, taking ownership of the content. */
+static ViewUpdate *
+new_view_update(const FetchJob *job, char *txt, GdkPixbuf *img, SimilarInfo *similar, size_t size) {
+
+    ViewUpdate *update = calloc(1, sizeof(ViewUpdate));
+    if (!update) {
+        free(txt);
+        if (img)
+            g_object_unref(img);
+        if (similar)
+            free_sim_list(similar, size);
+        return NULL;
+    }
+    deadbeef->pl_item_ref(job->track);
+    update->track = job->track;
+    update->generation = job->generation;
+    update->txt = txt;
+    update->img = img;
+    update->similar = similar;
+    update->size = size;
+    return update;
+}
+
+static void
+post_lyrics(const FetchJob *job, char *lyr_txt, const char *artist, const char *title) {
+
+    ViewUpdate *update = new_view_update(job, lyr_txt, NULL, NULL, 0);
+    if (update) {
+        /* Lyrics carry the metadata they were fetched for, so the GUI
+         * thread doesn't have to lock the playlist to show them. */
+        update->artist = artist ? strdup(artist) : NULL;
+        update->title = title ? strdup(title) : NULL;
+        post_update(VIEW_LYRICS, update);
+    }
+}
+
+static void
+post_bio(const FetchJob *job, char *bio_txt, GdkPixbuf *img) {
+
+    ViewUpdate *update = new_view_update(job, bio_txt, img, NULL, 0);
+    if (update)
+        post_update(VIEW_BIO, update);
+}
+
+static void
+post_similar(const FetchJob *job, SimilarInfo *similar, size_t size) {
+
+    ViewUpdate *update = new_view_update(job, NULL, NULL, similar, size);
+    if (update)
+        post_update(VIEW_SIMILAR, update);
+}
+
+/* Drops the updates, which weren't dispatched yet. */
+static void
+cancel_updates(void) {
+
+    pthread_mutex_lock(&update_mutex);
+    if (dispatch_source) {
+        g_source_remove(dispatch_source);
+        dispatch_source = 0;
+    }
+    for (int i = 0; i < VIEWS_COUNT; ++i) {
+        if (pending_updates[i]) {
+            free_view_update(pending_updates[i]);
+            pending_updates[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&update_mutex);
+}
+
 static void
 retrieve_similar_artists(void *ctx) {
 
     trace("infobar: retrieving similar artists\n");
-    DB_playItem_t *track = (DB_playItem_t*) ctx;
+    FetchJob *job = ctx;
+    DB_playItem_t *track = job->track;
+    uint64_t worker_span = span_begin();
 
     size_t size = 0;
-    char *artist = NULL;
+    TrackMeta *meta = NULL;
     SimilarInfo *similar = NULL;
 
-    if (!is_track_changed(track)) {
-
-        SimilarInfo loading = {0};
-        loading.name = "Loading...";
+    if (!is_job_stale(job)) {
 
-        gdk_threads_enter();
-        update_similar_view(&loading, 1);
-        gdk_threads_leave();
+        SimilarInfo *loading = calloc(1, sizeof(SimilarInfo));
+        if (loading) {
+            loading->name = strdup("Loading...");
+            post_similar(job, loading, 1);
+        }
 
-        if (get_artist_info(track, &artist) == -1)
+        meta = get_track_meta(track);
+        if (!meta)
             goto update;
 
-        if (fetch_similar_artists(artist, &similar, &size) == -1) {
-            free(artist);
-            goto update;
+        /* Cancelled fetch posts nothing, its view belongs to the next
+         * song's fetch by now. */
+        FetchPriority prio = PRIORITY_BACKGROUND;
+        if (wait_for_fetch(job) == -1 || begin_fetch(job, &prio) == -1) {
+            free(meta);
+            free(job);
+            span_end(worker_span, "similar", SPAN_WORKER);
+            return;
         }
-        free(artist);
+
+        if (lookup_similar_artists(meta->artist, &similar, &size) == 0) {
+            /* Match values are formatted here, so the GUI thread just shows them. */
+            for (size_t i = 0; i < size; ++i) {
+                if (similar[i].match && string_to_perc(similar[i].match, similar[i].perc) == -1)
+                    similar[i].perc[0] = '\0';
+            }
+        }
+        end_fetch(prio);
     }
 
 update:
-    if (!is_track_changed(track)) {
-        gdk_threads_enter();
-        update_similar_view(similar, size);
-        gdk_threads_leave();
-    }
-    if (similar)
+    free(meta);
+    if (!is_job_stale(job))
+        post_similar(job, similar, size);
+    else if (similar)
         free_sim_list(similar, size);
+
+    free(job);
+    span_end(worker_span, "similar", SPAN_WORKER);
+}
+
+/* Posts partially downloaded artist's image. */
+static void
+post_bio_progress(GdkPixbuf *img, void *ctx) {
+
+    FetchJob *job = ctx;
+    if (!is_job_stale(job))
+        post_bio(job, strdup("Loading..."), img);
+    else
+        g_object_unref(img);
 }
 
 static void
 retrieve_artist_bio(void *ctx) {
 
     trace("infobar: retrieving artist's biography\n");
-    DB_playItem_t *track = (DB_playItem_t*) ctx;
+    FetchJob *job = ctx;
+    DB_playItem_t *track = job->track;
+    uint64_t worker_span = span_begin();
 
-    char *bio_txt = NULL, *artist = NULL, *img_cache = NULL;
+    char *bio_txt = NULL, *img_cache = NULL;
+    TrackMeta *meta = NULL;
+    GdkPixbuf *img = NULL;
 
-    if (!is_track_changed(track)) {
+    /* Image is fetched at the size, which suits the image area. */
+    int width = 0, height = 0;
+    infobar_bio_image_size(&width, &height);
+    ImgSize img_size = choose_img_size(width, height);
 
-        gdk_threads_enter();
-        update_bio_view("Loading...", NULL);
-        gdk_threads_leave();
+    if (!is_job_stale(job)) {
 
-        if (get_artist_info(track, &artist) == -1)
+        meta = get_track_meta(track);
+        if (!meta)
             goto update;
 
-        char *txt_cache = NULL;
-        if (create_bio_cache(artist, &txt_cache, &img_cache) == -1) {
-            free(artist);
-            goto update;
-        }
+        const char *artist = meta->artist;
 
-        if (!is_exists(txt_cache) || is_old_cache(txt_cache, BIO)) {
-            /* There is no cache for artist's biography or it's
-             * too old, retrieving new one. */
-            if (fetch_bio_txt(artist, &bio_txt) == 0) {
-
-                /* Making sure, that retrieved text has UTF-8 encoding,
-                 * otherwise converting it. */
-                char *bio_utf8 = NULL;
-                if (deadbeef->junk_detect_charset(bio_txt)) {
-                    if (convert_to_utf8(bio_txt, &bio_utf8) == 0) {
-                        free(bio_txt);
-                        bio_txt = bio_utf8;
-                    }
-                }
-                /* Saving biography to reuse it later. */
-                save_txt_file(txt_cache, bio_txt);
-            }
-        } else {
-            /* We got a cached biography, just loading it. */
-            load_txt_file(txt_cache, &bio_txt);
-        }
-        free(txt_cache);
+        /* Cached biography is shown at once, fetching is delayed. */
+        if (lookup_cached_bio(artist, img_size, &bio_txt, &img_cache) == -1) {
+            post_bio(job, strdup("Loading..."), NULL);
 
-        /* Retrieving artist's image if we don't have a cached one. */
-        if (!is_exists(img_cache) || is_old_cache(img_cache, BIO))
-            fetch_bio_image(artist, img_cache);
+            /* Cancelled fetch posts nothing, its view belongs to the next
+             * song's fetch by now. */
+            FetchPriority prio = PRIORITY_BACKGROUND;
+            if (wait_for_fetch(job) == -1 || begin_fetch(job, &prio) == -1) {
+                free(meta);
+                free(job);
+                span_end(worker_span, "bio", SPAN_WORKER);
+                return;
+            }
 
-        free(artist);
+            /* Downloaded image is decoded and shown as it arrives. */
+            ImgStream stream = {0};
+            img_stream_init(&stream, width, height, post_bio_progress, job);
+            ImgSink sink = { img_stream_write, &stream };
+
+            lookup_artist_bio(artist, img_size, &bio_txt, &img_cache, &sink);
+            end_fetch(prio);
+
+            img = img_stream_finish(&stream);
+            /* Image, which failed to download, isn't cached. */
+            if (img && !is_exists(img_cache)) {
+                g_object_unref(img);
+                img = NULL;
+            } else if (img) {
+                remember_bio_image(img_cache, width, height, img);
+            }
+        }
     }
 
 update:
-    if (!is_track_changed(track)) {
-        gdk_threads_enter();
-        update_bio_view(bio_txt, img_cache);
-        gdk_threads_leave();
-    }
-    if (bio_txt)
+    free(meta);
+    if (!is_job_stale(job)) {
+        /* Cached image is decoded here, so the GUI thread just paints it. */
+        if (!img && img_cache)
+            img = load_bio_image(img_cache, width, height);
+
+        post_bio(job, bio_txt, img);
+    } else {
         free(bio_txt);
-
-    if (img_cache)
-        free(img_cache);
+        if (img)
+            g_object_unref(img);
+    }
+    free(img_cache);
+    free(job);
+    span_end(worker_span, "bio", SPAN_WORKER);
 }
 
 static void
 retrieve_track_lyrics(void *ctx) {
 
     trace("infobar: retrieving track lyrics\n");
-    DB_playItem_t *track = (DB_playItem_t*) ctx;
-
-    char *lyr_txt = NULL, *artist = NULL, *title = NULL, *album = NULL;
+    FetchJob *job = ctx;
+    DB_playItem_t *track = job->track;
+    uint64_t worker_span = span_begin();
 
-    if (!is_track_changed(track)) {
+    char *lyr_txt = NULL;
+    const char *artist = NULL, *title = NULL;
+    TrackMeta *meta = NULL;
 
-        gdk_threads_enter();
-        update_lyrics_view("Loading...", track);
-        gdk_threads_leave();
+    if (!is_job_stale(job)) {
 
-        if (get_full_track_info(track, &artist, &title, &album) == -1)
+        meta = get_track_meta(track);
+        if (!meta || !meta->title)
             goto update;
 
-        char *txt_cache = NULL;
-        if (create_lyr_cache(artist, title, &txt_cache) == -1) {
-            free(artist);
-            free(title);
-            free(album);
-            goto update;
-        }
-
-        if (!is_exists(txt_cache) || is_old_cache(txt_cache, LYRICS)) {
-            /* There is no cache for the current track or the previous cache
-             * is too old, so start retrieving new one. */
-            if (deadbeef->conf_get_int(CONF_LYRICSWIKIA_ENABLED, 1) && !lyr_txt)
-                fetch_lyrics_from_lyricswikia(artist, title, &lyr_txt);
-
-            if (deadbeef->conf_get_int(CONF_LYRICSMANIA_ENABLED, 1) && !lyr_txt)
-                fetch_lyrics_from_lyricsmania(artist, title, &lyr_txt);
-
-            if (deadbeef->conf_get_int(CONF_LYRICSTIME_ENABLED, 1) && !lyr_txt)
-                fetch_lyrics_from_lyricstime(artist, title, &lyr_txt);
-
-            if (deadbeef->conf_get_int(CONF_MEGALYRICS_ENABLED, 1) && !lyr_txt)
-                fetch_lyrics_from_megalyrics(artist, title, &lyr_txt);
-
-            if (deadbeef->conf_get_int(CONF_LYRICS_SCRIPT_ENABLED, 0) && !lyr_txt)
-                fetch_lyrics_from_script(artist, title, album, &lyr_txt);
-
-            if (lyr_txt) {
-                char *lyr_wo_nl = NULL;
-                /* Some lyrics contains new line characters at the
-                 * beginning of the text, so we gonna strip them. */
-                if (del_nl(lyr_txt, &lyr_wo_nl) == 0) {
-                    free(lyr_txt);
-                    lyr_txt = lyr_wo_nl;
-                }
-
-                /* Making sure, that retrieved text has UTF-8 encoding,
-                 * otherwise converting it. */
-                char *lyr_utf8 = NULL;
-                if (deadbeef->junk_detect_charset(lyr_txt)) {
-                    if (convert_to_utf8(lyr_txt, &lyr_utf8) == 0) {
-                        free(lyr_txt);
-                        lyr_txt = lyr_utf8;
-                    }
-                }
-                /* Saving lyrics to reuse it later.*/
-                save_txt_file(txt_cache, lyr_txt);
+        artist = meta->artist;
+        title = meta->title;
+
+        /* Cached lyrics are shown at once, fetching is delayed. */
+        if (lookup_cached_lyrics(artist, title, &lyr_txt) == -1) {
+            post_lyrics(job, strdup("Loading..."), artist, title);
+
+            /* Cancelled fetch posts nothing, its view belongs to the next
+             * song's fetch by now. */
+            FetchPriority prio = PRIORITY_BACKGROUND;
+            if (wait_for_fetch(job) == -1 || begin_fetch(job, &prio) == -1) {
+                free(meta);
+                free(job);
+                span_end(worker_span, "lyrics", SPAN_WORKER);
+                return;
             }
-        } else {
-            /* We got a cache for the current track, so just loading it. */
-            load_txt_file(txt_cache, &lyr_txt);
+            lookup_track_lyrics(artist, title, meta->album, &lyr_txt);
+            end_fetch(prio);
         }
-        free(txt_cache);
-        free(artist);
-        free(title);
-        free(album);
     }
 
 update:
-    if (!is_track_changed(track)) {
-        gdk_threads_enter();
-        update_lyrics_view(lyr_txt, track);
-        gdk_threads_leave();
-    }
-    if (lyr_txt)
+    if (!is_job_stale(job))
+        post_lyrics(job, lyr_txt, artist, title);
+    else
         free(lyr_txt);
+
+    free(meta);
+    free(job);
+
+    span_end(worker_span, "lyrics", SPAN_WORKER);
+}
+
+/* Hashes the value of the track's meta field into the fingerprint.
+ * Should be called with the playlist locked. */
+static uint64_t
+hash_meta(DB_playItem_t *track, const char *key, uint64_t hash) {
+
+    const char *value = deadbeef->pl_find_meta(track, key);
+    for (const char *c = value ? value : ""; *c; ++c)
+        hash = (hash ^ (unsigned char) *c) * 1099511628211ull;
+
+    /* Separating the fields, so "ab" + "c" differs from "a" + "bc". */
+    return (hash ^ 0xff) * 1099511628211ull;
+}
+
+/* Decides what has to be refetched after the stream's track info changed.
+ * Lyrics depend on the whole song, biography and similar artists only
+ * on the artist. */
+static FetchMask
+stream_changes(DB_playItem_t *track) {
+
+    deadbeef->pl_lock();
+    uint64_t artist = hash_meta(track, "artist", 14695981039346656037ull);
+    uint64_t song = hash_meta(track, "album", hash_meta(track, "title", artist));
+    deadbeef->pl_unlock();
+
+    FetchMask mask = FETCH_ALL;
+    if (stream_fp.track == track && stream_fp.artist == artist)
+        mask = stream_fp.song == song ? 0 : FETCH_LYRICS;
+
+    stream_fp.track = track;
+    stream_fp.artist = artist;
+    stream_fp.song = song;
+    return mask;
+}
+
+/* Starts the worker, which fetches the view's content for the song. */
+static void
+start_fetch(void (*worker)(void *ctx), DB_playItem_t *track, InfobarView view, unsigned generation) {
+
+    FetchJob *job = malloc(sizeof(FetchJob));
+    if (!job)
+        return;
+
+    job->track = track;
+    job->view = view;
+    job->generation = generation;
+
+    intptr_t tid = deadbeef->thread_start(worker, job);
+    if (tid)
+        deadbeef->thread_detach(tid);
+    else
+        free(job);
 }
 
 static void
-infobar_songstarted(ddb_event_track_t *ev) {
+infobar_songstarted(ddb_event_track_t *ev, FetchMask mask) {
 
     trace("infobar: infobar song started\n");
 
+    /* Fetches of the replaced song give up, even if the stream's track
+     * stays the same. Views, which aren't refetched, keep their fetches. */
+    unsigned generation[VIEWS_COUNT] = {0};
+    pthread_mutex_lock(&fetch_mutex);
+    for (int i = 0; i < VIEWS_COUNT; ++i) {
+        int refetch = i == VIEW_LYRICS ? mask & FETCH_LYRICS : mask & FETCH_ARTIST;
+        if (refetch)
+            __atomic_add_fetch(&fetch_generation[i], 1, __ATOMIC_RELAXED);
+        generation[i] = __atomic_load_n(&fetch_generation[i], __ATOMIC_RELAXED);
+    }
+    pthread_cond_broadcast(&fetch_cond);
+    pthread_mutex_unlock(&fetch_mutex);
+
     /* Don't retrieve anything as all tabs are invisible. */
     if (!deadbeef->conf_get_int(CONF_LYRICS_ENABLED, 1) &&
         !deadbeef->conf_get_int(CONF_BIO_ENABLED, 1) &&
@@ -220,20 +627,52 @@ infobar_songstarted(ddb_event_track_t *ev) {
         return;
     }
 
-    if (deadbeef->conf_get_int(CONF_LYRICS_ENABLED, 1)) {
-        intptr_t tid = deadbeef->thread_start(retrieve_track_lyrics, ev->track);
-        deadbeef->thread_detach(tid);
-    }
-    if (deadbeef->conf_get_int(CONF_BIO_ENABLED, 1)) {
-        intptr_t tid = deadbeef->thread_start(retrieve_artist_bio, ev->track);
-        deadbeef->thread_detach(tid);
-    }
-    if (deadbeef->conf_get_int(CONF_SIM_ENABLED, 1)) {
-        intptr_t tid = deadbeef->thread_start(retrieve_similar_artists, ev->track);
-        deadbeef->thread_detach(tid);
+    if ((mask & FETCH_LYRICS) && deadbeef->conf_get_int(CONF_LYRICS_ENABLED, 1))
+        start_fetch(retrieve_track_lyrics, ev->track, VIEW_LYRICS, generation[VIEW_LYRICS]);
+
+    if ((mask & FETCH_ARTIST) && deadbeef->conf_get_int(CONF_BIO_ENABLED, 1))
+        start_fetch(retrieve_artist_bio, ev->track, VIEW_BIO, generation[VIEW_BIO]);
+
+    if ((mask & FETCH_ARTIST) && deadbeef->conf_get_int(CONF_SIM_ENABLED, 1))
+        start_fetch(retrieve_similar_artists, ev->track, VIEW_SIMILAR, generation[VIEW_SIMILAR]);
+}
+
+/* Periodically writes statistics of the recorded timing spans to the log. */
+static void
+log_spans_stats(void *ctx) {
+
+    int elapsed = 0;
+    while (!__atomic_load_n(&spans_stop, __ATOMIC_RELAXED)) {
+        sleep(1);
+
+        int period = deadbeef->conf_get_int(CONF_TRACE_STATS_PERIOD, 0);
+        if (period > 0 && ++elapsed >= period) {
+            spans_log_stats(stderr);
+            elapsed = 0;
+        }
     }
 }
 
+/* Applies timing spans configuration. Stats logging thread is started
+ * the first time it's needed and lives until the plug-in is disconnected. */
+static void
+spans_config_changed(void) {
+
+    int enabled = deadbeef->conf_get_int(CONF_TRACE_ENABLED, 0);
+    spans_set_enabled(enabled);
+
+    if (enabled && !spans_tid && deadbeef->conf_get_int(CONF_TRACE_STATS_PERIOD, 0) > 0)
+        spans_tid = deadbeef->thread_start(log_spans_stats, NULL);
+}
+
+/* Applies the new configuration to the widget on the main loop. */
+static gboolean
+config_changed(gpointer data) {
+
+    infobar_config_changed();
+    return FALSE;
+}
+
 static int
 infobar_message(struct ddb_gtkui_widget_s *w, uint32_t id, uintptr_t ctx, uint32_t p1, uint32_t p2) {
 
@@ -246,26 +685,38 @@ infobar_message(struct ddb_gtkui_widget_s *w, uint32_t id, uintptr_t ctx, uint32
         if (!event->track)
             return 0;
 
+        /* Restarted stream has to be fetched again, even if the station
+         * still plays the same song. */
+        stream_fp.track = NULL;
+
+        /* Fetches waiting for the previous track should give up. */
+        infobar_reschedule_fetches();
+
         if (!is_stream(event->track))
-            infobar_songstarted(event);
+            infobar_songstarted(event, FETCH_ALL);
     }
         break;
+    case DB_EV_STOP:
+        /* Nothing is current anymore, so the delayed fetches give up. */
+        infobar_reschedule_fetches();
+        break;
     case DB_EV_TRACKINFOCHANGED:
     {
         trace("infobar: recieved trackinfochanged message\n");
         ddb_event_track_t* event = (ddb_event_track_t*) ctx;
 
-        if (!event->track)
+        if (!event->track || !is_stream(event->track))
             return 0;
 
-        if (is_stream(event->track))
-            infobar_songstarted(event);
+        /* Only real song changes are worth fetching. */
+        FetchMask mask = stream_changes(event->track);
+        if (mask)
+            infobar_songstarted(event, mask);
     }
         break;
     case DB_EV_CONFIGCHANGED:
-        gdk_threads_enter();
-        infobar_config_changed();
-        gdk_threads_leave();
+        spans_config_changed();
+        gdk_threads_add_idle(config_changed, NULL);
         break;
     }
     return 0;
@@ -296,6 +747,10 @@ infobar_connect(void) {
         return -1;
     }
     gtkui_plugin->w_reg_widget(WIDGET_LABEL, 0, w_infobar_create, WIDGET_ID, NULL);
+    spans_config_changed();
+    breaker_reset();
+    http_init();
+    __atomic_store_n(&fetch_stop, 0, __ATOMIC_RELAXED);
     return 0;
 }
 
@@ -306,6 +761,33 @@ infobar_disconnect(void) {
     if (gtkui_plugin) {
         gtkui_plugin->w_unreg_widget(WIDGET_ID);
     }
+
+    __atomic_store_n(&fetch_stop, 1, __ATOMIC_RELAXED);
+    infobar_reschedule_fetches();
+    cancel_updates();
+    forget_bio_images();
+    watchdog_shutdown();
+    http_shutdown();
+
+    if (spans_tid) {
+        __atomic_store_n(&spans_stop, 1, __ATOMIC_RELAXED);
+        deadbeef->thread_join(spans_tid);
+        spans_tid = 0;
+    }
+
+    /* Exporting recorded timing spans and statistics, if requested. */
+    deadbeef->conf_lock();
+    const char *trace_file = deadbeef->conf_get_str_fast(CONF_TRACE_FILE, "");
+    if (deadbeef->conf_get_int(CONF_TRACE_ENABLED, 0) && *trace_file) {
+        if (spans_export_json(trace_file) == -1)
+            fprintf(stderr, "infobar: can't export timing spans to %s\n", trace_file);
+    }
+    const char *stats_file = deadbeef->conf_get_str_fast(CONF_STATS_FILE, "");
+    if (*stats_file) {
+        if (stats_dump(stats_file) == -1)
+            fprintf(stderr, "infobar: can't write statistics to %s\n", stats_file);
+    }
+    deadbeef->conf_unlock();
     return 0;
 }
 
@@ -315,6 +797,7 @@ static const char settings_dlg[] =
     "property \"Fetch from Lyricsmania\" checkbox infobar.lyrics.lyricsmania 1;"
     "property \"Fetch from Lyricstime\" checkbox infobar.lyrics.lyricstime 1;"
     "property \"Fetch from Megalyrics\" checkbox infobar.lyrics.megalyrics 1;"
+    "property \"Order lyrics sources by observed speed and success\" checkbox infobar.lyrics.adaptive 1;"
     "property \"Fetch from script\" checkbox infobar.lyrics.script 0;"
     "property \"Lyrics script path\" file infobar.lyrics.script.path \"\";"
     "property \"Lyrics alignment type\" select[3] infobar.lyrics.alignment 0 left center right;"
@@ -322,8 +805,31 @@ static const char settings_dlg[] =
     "property \"Enable biography\" checkbox infobar.bio.enabled 1;"
     "property \"Biography locale\" entry infobar.bio.locale \"en\";"
     "property \"Biography cache update period (hr)\" spinbtn[0,99,1] infobar.bio.cache.period 24;"
+    "property \"Memory for recent artist images (MB)\" spinbtn[0,256,4] infobar.bio.image.memory 16;"
     "property \"Enable similar artists\" checkbox infobar.similar.enabled 1;"
     "property \"Max number of similar artists\" spinbtn[0,99,1] infobar.similar.max.artists 10;"
+    "property \"Delay before fetching, while tracks are skipped (ms)\" spinbtn[0,2000,50] infobar.fetch.delay 200;"
+    "property \"Fetch hidden tabs after (sec, 0 - only when shown)\" spinbtn[0,600,5] infobar.fetch.idle 0;"
+    "property \"Use built-in HTTP client (keep-alive, gzip)\" checkbox infobar.http.enabled 1;"
+    "property \"Connections per source\" spinbtn[1,8,1] infobar.http.max.connections 2;"
+    "property \"Lyricswikia connect timeout (sec)\" spinbtn[0,120,1] infobar.lyricswikia.timeout.connect 5;"
+    "property \"Lyricswikia read timeout (sec)\" spinbtn[0,300,1] infobar.lyricswikia.timeout.read 15;"
+    "property \"Lyricsmania connect timeout (sec)\" spinbtn[0,120,1] infobar.lyricsmania.timeout.connect 5;"
+    "property \"Lyricsmania read timeout (sec)\" spinbtn[0,300,1] infobar.lyricsmania.timeout.read 15;"
+    "property \"Lyricstime connect timeout (sec)\" spinbtn[0,120,1] infobar.lyricstime.timeout.connect 5;"
+    "property \"Lyricstime read timeout (sec)\" spinbtn[0,300,1] infobar.lyricstime.timeout.read 15;"
+    "property \"Megalyrics connect timeout (sec)\" spinbtn[0,120,1] infobar.megalyrics.timeout.connect 5;"
+    "property \"Megalyrics read timeout (sec)\" spinbtn[0,300,1] infobar.megalyrics.timeout.read 15;"
+    "property \"Lastfm connect timeout (sec)\" spinbtn[0,120,1] infobar.lastfm.timeout.connect 5;"
+    "property \"Lastfm read timeout (sec)\" spinbtn[0,300,1] infobar.lastfm.timeout.read 15;"
+    "property \"Failures to stop using a source (0 - never)\" spinbtn[0,100,1] infobar.breaker.threshold 5;"
+    "property \"Time before retrying a failed source (sec)\" spinbtn[1,3600,10] infobar.breaker.backoff 60;"
+    "property \"Sources state (read-only)\" entry infobar.breaker.state \"all closed\";"
+    "property \"Show statistics tab\" checkbox infobar.stats.enabled 0;"
+    "property \"Statistics file (written on exit)\" file infobar.stats.file \"\";"
+    "property \"Record timing spans\" checkbox infobar.trace.enabled 0;"
+    "property \"Timing spans trace file (Chrome JSON)\" file infobar.trace.file \"\";"
+    "property \"Timing stats log period (sec)\" spinbtn[0,3600,10] infobar.trace.stats.period 0;"
 ;
 
 static DB_misc_t plugin = {
@@ -26,38 +26,24 @@
 #include <gtk/gtk.h>
 #include <deadbeef/deadbeef.h>
 
+#include "core.h"
 #include "ui.h"
 #include "utils.h"
 #include "lyrics.h"
 #include "similar.h"
 #include "biography.h"
 
-//#define trace(...) { fprintf(stderr, __VA_ARGS__); }
-#define trace(fmt, ...)
-
-/* Predefined names of infobar properties. */
-#define CONF_LYRICS_ENABLED "infobar.lyrics.enabled"
-#define CONF_LYRICSWIKIA_ENABLED "infobar.lyrics.lyricswikia"
-#define CONF_LYRICSMANIA_ENABLED "infobar.lyrics.lyricsmania"
-#define CONF_LYRICSTIME_ENABLED "infobar.lyrics.lyricstime"
-#define CONF_MEGALYRICS_ENABLED "infobar.lyrics.megalyrics"
-#define CONF_LYRICS_SCRIPT_ENABLED "infobar.lyrics.script"
-#define CONF_LYRICS_ALIGNMENT "infobar.lyrics.alignment"
-#define CONF_BIO_ENABLED "infobar.bio.enabled"
-#define CONF_BIO_LOCALE "infobar.bio.locale"
-#define CONF_LYRICS_SCRIPT_PATH "infobar.lyrics.script.path"
-#define CONF_LYRICS_UPDATE_PERIOD "infobar.lyrics.cache.period"
-#define CONF_BIO_UPDATE_PERIOD "infobar.bio.cache.period"
-#define CONF_SIM_ENABLED "infobar.similar.enabled"
-#define CONF_SIM_MAX_ARTISTS "infobar.similar.max.artists"
-
 #define WIDGET_ID "infobar"
 #define WIDGET_LABEL "Infobar"
 
-/* deadbeef API. */
-DB_functions_t *deadbeef;
+/* Default delay before fetching the content of the new track, in ms. */
+#define DEF_FETCH_DELAY 200
 
 /* UI plugin. */
-ddb_gtkui_t *gtkui_plugin;
+extern ddb_gtkui_t *gtkui_plugin;
+
+/* Should be called, when the visible view changes. Waiting fetches check
+ * their priority again, so the newly shown view is fetched first. */
+void infobar_reschedule_fetches(void);
 
 #endif
@@ -61,8 +61,7 @@ form_script_cmd(const char *artist, const char* title, const char *album,
 }
 
 /* Formats lyrics fetched from "http://megalyrics.ru". */
-static int
-format_megalyrics(const char *lyr, char **fmd) {
+int format_megalyrics(const char *lyr, char **fmd) {
     
     /* Removing <pre> and <h2> tags from the beginning. */
     char *wo_bpre = NULL;
@@ -89,8 +88,7 @@ format_megalyrics(const char *lyr, char **fmd) {
 }
 
 /* Parses lyrics fetched from "http://megalyrics.ru". */
-static int
-parse_megalyrics(const char *content, char **psd) {
+int parse_megalyrics(const char *content, char **psd) {
     
     xmlDocPtr doc = NULL;
     if (init_doc_obj(content, HTML, &doc) == -1)
@@ -125,8 +123,7 @@ parse_megalyrics(const char *content, char **psd) {
 }
 
 /* Performs 2nd step of parsing lyrics from "http://lyrics.wikia.com". */
-static int
-parse_lyricswikia(const char *content, char **psd) {
+int parse_lyricswikia(const char *content, char **psd) {
     
     xmlDocPtr doc = NULL;
     if (init_doc_obj(content, HTML, &doc) == -1)
@@ -169,21 +166,23 @@ parse_lyricswikia(const char *content, char **psd) {
 
 /* Performs 1st step of fetching and parsing lyrics from "http://lyrics.wikia.com". */
 static int
-fetch_xml_from_lyricswikia(const char *artist, const char *title, char **xml) {
+fetch_xml_from_lyricswikia(const char *artist, const char *title, Validators *val, char **xml) {
     
     char *url = NULL;
     if (form_lyr_url(artist, title, LW_URL_TEMP, FALSE, &url) == -1)
         return -1;
     
     char *raw_page = NULL;
-    if (retrieve_txt_content(url, &raw_page) == -1) {
+    int res = retrieve_txt_content(url, LYRICSWIKIA, val, &raw_page);
+    if (res != 0) {
         free(url);
-        return -1;
+        return res;
     }
     free(url);
     
     char *psd = NULL;
     if (parse_common(raw_page, LW_XML_EXP, XML, &psd) == -1) {
+        stats_parse_failure(LYRICSWIKIA);
         free(raw_page);
         return -1;
     }
@@ -193,21 +192,23 @@ fetch_xml_from_lyricswikia(const char *artist, const char *title, char **xml) {
 }
 
 /* Fetches lyrics from "http://lyricsmania.com". */
-int fetch_lyrics_from_lyricsmania(const char *artist, const char *title, char **lyr) {
+int fetch_lyrics_from_lyricsmania(const char *artist, const char *title, Validators *val, char **lyr) {
     
     char *url = NULL;
     if (form_lyr_url(artist, title, LM_URL_TEMP, TRUE, &url) == -1)
         return -1;
     
     char *raw_page = NULL;
-    if (retrieve_txt_content(url, &raw_page) == -1) {
+    int res = retrieve_txt_content(url, LYRICSMANIA, val, &raw_page);
+    if (res != 0) {
         free(url);
-        return -1;
+        return res;
     }
     free(url);
     
     char *psd = NULL;
     if (parse_common(raw_page, LM_EXP, HTML, &psd) == -1) {
+        stats_parse_failure(LYRICSMANIA);
         free(raw_page);
         return -1;
     }
@@ -217,21 +218,23 @@ int fetch_lyrics_from_lyricsmania(const char *artist, const char *title, char **
 }
 
 /* Fetches lyrics from "http://lyricstime.com". */
-int fetch_lyrics_from_lyricstime(const char *artist, const char *title, char **lyr) {
+int fetch_lyrics_from_lyricstime(const char *artist, const char *title, Validators *val, char **lyr) {
     
     char *url = NULL;
     if (form_lyr_url(artist, title, LT_URL_TEMP, FALSE, &url) == -1)
         return -1;
     
     char *raw_page = NULL;
-    if (retrieve_txt_content(url, &raw_page) == -1) {
+    int res = retrieve_txt_content(url, LYRICSTIME, val, &raw_page);
+    if (res != 0) {
         free(url);
-        return -1;
+        return res;
     }
     free(url);
     
     char *psd = NULL;
     if (parse_common(raw_page, LT_EXP, HTML, &psd) == -1) {
+        stats_parse_failure(LYRICSTIME);
         free(raw_page);
         return -1;
     }
@@ -241,21 +244,23 @@ int fetch_lyrics_from_lyricstime(const char *artist, const char *title, char **l
 }
 
 /* Fetches lyrics from "http://megalyrics.ru". */
-int fetch_lyrics_from_megalyrics(const char *artist, const char *title, char **lyr) {
+int fetch_lyrics_from_megalyrics(const char *artist, const char *title, Validators *val, char **lyr) {
     
     char *url = NULL;
     if (form_lyr_url(artist, title, ML_URL_TEMP, FALSE, &url) == -1)
         return -1;
     
     char *raw_page = NULL;
-    if (retrieve_txt_content(url, &raw_page) == -1) {
+    int res = retrieve_txt_content(url, MEGALYRICS, val, &raw_page);
+    if (res != 0) {
         free(url);
-        return -1;
+        return res;
     }
     free(url);
     
     char *psd = NULL;
     if (parse_megalyrics(raw_page, &psd) == -1) {
+        stats_parse_failure(MEGALYRICS);
         free(raw_page);
         return -1;
     }
@@ -271,11 +276,12 @@ int fetch_lyrics_from_megalyrics(const char *artist, const char *title, char **l
 }
 
 /* Fetches lyrics from "http://lyrics.wikia.com". */
-int fetch_lyrics_from_lyricswikia(const char *artist, const char *title, char **lyr) {
+int fetch_lyrics_from_lyricswikia(const char *artist, const char *title, Validators *val, char **lyr) {
     
     char *xml = NULL;
-    if (fetch_xml_from_lyricswikia(artist, title, &xml) == -1)
-        return -1;
+    int res = fetch_xml_from_lyricswikia(artist, title, val, &xml);
+    if (res != 0)
+        return res;
     
     /* Checking if we got a redirect. Read more about redirects 
      * here: "http://lyrics.wikia.com/Help:Redirect". */
@@ -285,11 +291,13 @@ int fetch_lyrics_from_lyricswikia(const char *artist, const char *title, char **
         if (get_redirect_info(xml, &rartist, &rtitle) == 0) {
             
             free(xml);
+            xml = NULL;
             /* Retrieving lyrics again, using correct artist name and song title. */
-            if (fetch_xml_from_lyricswikia(rartist, rtitle, &xml) == -1) {
+            res = fetch_xml_from_lyricswikia(rartist, rtitle, val, &xml);
+            if (res != 0) {
                 free(rartist);
                 free(rtitle);
-                return -1;
+                return res;
             }
             free(rartist);
             free(rtitle);
@@ -297,6 +305,7 @@ int fetch_lyrics_from_lyricswikia(const char *artist, const char *title, char **
     }
     char *psd = NULL;
     if (parse_lyricswikia(xml, &psd) == -1) {
+        stats_parse_failure(LYRICSWIKIA);
         free(xml);
         return -1;
     }
@@ -319,9 +328,11 @@ int fetch_lyrics_from_script(const char *artist, const char *title, const char *
     deadbeef->conf_unlock();
     
     if (execute_script(cmd, lyr) == -1) {
+        stats_error(LYRICS_SCRIPT);
         free(cmd);
         return -1;
     }
+    stats_bytes(LYRICS_SCRIPT, strlen(*lyr));
     free(cmd);
     return 0;
 }
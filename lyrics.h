@@ -23,10 +23,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <gtk/gtk.h>
 #include <deadbeef/deadbeef.h>
 
-#include "infobar.h"
+#include "core.h"
 #include "utils.h"
 
 /* URL templates to retrieve lyrics from different sources. */
@@ -47,17 +46,29 @@
 #define ML_LYR_BEG "<pre class=\"lyric\"><h2>Текст песни</h2>"
 #define ML_LYR_END "</pre>"
 
+/* Performs 2nd step of parsing lyrics from "http://lyrics.wikia.com". */
+int parse_lyricswikia(const char *content, char **psd);
+
+/* Parses lyrics fetched from "http://megalyrics.ru". */
+int parse_megalyrics(const char *content, char **psd);
+
+/* Formats lyrics fetched from "http://megalyrics.ru". */
+int format_megalyrics(const char *lyr, char **fmd);
+
+/* Validators of the cached lyrics, if specified, make the requests
+ * conditional, see retrieve_txt_content(). */
+
 /* Fetches lyrics from "http://lyrics.wikia.com". */
-int fetch_lyrics_from_lyricswikia(const char *artist, const char *title, char **lyr);
+int fetch_lyrics_from_lyricswikia(const char *artist, const char *title, Validators *val, char **lyr);
 
 /* Fetches lyrics from "http://megalyrics.ru".  */
-int fetch_lyrics_from_megalyrics(const char *artist, const char *title, char **lyr);
+int fetch_lyrics_from_megalyrics(const char *artist, const char *title, Validators *val, char **lyr);
 
 /* Fetches lyrics from "http://lyricstime.com". */
-int fetch_lyrics_from_lyricstime(const char *artist, const char *title, char **lyr);
+int fetch_lyrics_from_lyricstime(const char *artist, const char *title, Validators *val, char **lyr);
 
 /* Fetches lyrics from "http://lyricsmania.com". */
-int fetch_lyrics_from_lyricsmania(const char *artist, const char *title, char **lyr);
+int fetch_lyrics_from_lyricsmania(const char *artist, const char *title, Validators *val, char **lyr);
 
 /* Fetches lyrics, using external bash script. */
 int fetch_lyrics_from_script(const char *artist, const char *title, const char *album, char **lyr);
@@ -0,0 +1,180 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "ranking.h"
+#include "stats.h"
+#include "utils.h"
+
+/* Observed behaviour of the provider. Successes and failures are decayed
+ * counts, so success probability is their Beta(1, 1) posterior mean. */
+typedef struct {
+    double successes;
+    double failures;
+    double latency;
+    int observed;
+} Rank;
+
+static Rank ranks[RANKED_PROVIDERS];
+static int dirty;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t loaded = PTHREAD_ONCE_INIT;
+
+/* Loads ranking saved by the previous session. Unknown and malformed
+ * lines are ignored, so the providers just start from the prior. */
+static void
+load_ranking(void) {
+
+    char *file = NULL;
+    if (create_ranking_cache(&file) == -1)
+        return;
+
+    FILE *in = fopen(file, "r");
+    free(file);
+    if (!in)
+        return;
+
+    char name[32] = {0};
+    double successes = 0, failures = 0, latency = 0;
+    while (fscanf(in, "%31s %lf %lf %lf", name, &successes, &failures, &latency) == 4) {
+        for (int i = 0; i < RANKED_PROVIDERS; ++i) {
+            if (strcmp(name, provider_name(i)) == 0 && successes >= 0 &&
+                failures >= 0 && latency > 0)
+            {
+                ranks[i].successes = successes;
+                ranks[i].failures = failures;
+                ranks[i].latency = latency;
+                ranks[i].observed = 1;
+            }
+        }
+    }
+    fclose(in);
+}
+
+/* Returns expected cost of the provider. Should be called with the mutex held. */
+static double
+expected_cost(const Rank *rank) {
+
+    double latency = rank->observed ? rank->latency : RANKING_PRIOR_LATENCY;
+    double success = (rank->successes + 1) / (rank->successes + rank->failures + 2);
+    return latency / success;
+}
+
+/* Records outcome of the attempt to fetch lyrics from the specified provider. */
+void ranking_update(Provider prov, uint64_t latency_us, int found) {
+
+    if (prov >= RANKED_PROVIDERS)
+        return;
+
+    pthread_once(&loaded, load_ranking);
+    pthread_mutex_lock(&mutex);
+
+    Rank *rank = &ranks[prov];
+    double latency = latency_us / 1000.0;
+
+    rank->successes = rank->successes * (1 - RANKING_DECAY) + (found ? 1 : 0);
+    rank->failures = rank->failures * (1 - RANKING_DECAY) + (found ? 0 : 1);
+    rank->latency = rank->observed ? rank->latency + RANKING_DECAY * (latency - rank->latency) : latency;
+    rank->observed = 1;
+    dirty = 1;
+
+    pthread_mutex_unlock(&mutex);
+}
+
+/* Sorts specified lyrics providers by their expected cost. Sort is stable,
+ * so providers with equal cost keep the order they were specified in. */
+void ranking_sort(Provider *order, size_t size) {
+
+    pthread_once(&loaded, load_ranking);
+    pthread_mutex_lock(&mutex);
+
+    double cost[RANKED_PROVIDERS] = {0};
+    for (int i = 0; i < RANKED_PROVIDERS; ++i)
+        cost[i] = expected_cost(&ranks[i]);
+
+    for (size_t i = 1; i < size; ++i) {
+        Provider prov = order[i];
+        if (prov >= RANKED_PROVIDERS)
+            continue;
+
+        size_t j = i;
+        while (j > 0 && order[j - 1] < RANKED_PROVIDERS && cost[order[j - 1]] > cost[prov]) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = prov;
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+/* Returns expected cost of the specified provider in milliseconds. */
+double ranking_cost(Provider prov) {
+
+    if (prov >= RANKED_PROVIDERS)
+        return 0;
+
+    pthread_once(&loaded, load_ranking);
+    pthread_mutex_lock(&mutex);
+    double cost = expected_cost(&ranks[prov]);
+    pthread_mutex_unlock(&mutex);
+    return cost;
+}
+
+/* Saves ranking to the cache, so it survives restarts. */
+int ranking_save(void) {
+
+    /* Mutex is held while writing, so concurrent
+     * saves don't interleave in the file. */
+    pthread_mutex_lock(&mutex);
+    if (!dirty) {
+        pthread_mutex_unlock(&mutex);
+        return 0;
+    }
+
+    char *file = NULL;
+    if (create_ranking_cache(&file) == -1) {
+        pthread_mutex_unlock(&mutex);
+        return -1;
+    }
+
+    FILE *out = fopen(file, "w");
+    free(file);
+    if (!out) {
+        pthread_mutex_unlock(&mutex);
+        return -1;
+    }
+
+    for (int i = 0; i < RANKED_PROVIDERS; ++i) {
+        if (ranks[i].observed) {
+            fprintf(out, "%s %.4f %.4f %.2f\n", provider_name(i), ranks[i].successes,
+                    ranks[i].failures, ranks[i].latency);
+        }
+    }
+    dirty = 0;
+    pthread_mutex_unlock(&mutex);
+
+    if (fclose(out) != 0)
+        return -1;
+    return 0;
+}
@@ -0,0 +1,53 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_RANKING_HEADER
+#define INFOBAR_RANKING_HEADER
+
+#include <stdint.h>
+
+#include "types.h"
+
+/* Number of lyrics providers, which are ranked. External script
+ * isn't ranked, it's always tried last. */
+#define RANKED_PROVIDERS 4
+
+/* Expected latency of the provider, which was never tried. */
+#define RANKING_PRIOR_LATENCY 1000.0
+
+/* Weight of the new observation in latency and success estimations.
+ * Older observations fade out, so providers, which went down or came
+ * back, are re-ranked after a few dozens of attempts. */
+#define RANKING_DECAY 0.05
+
+/* Records outcome of the attempt to fetch lyrics from the specified provider. */
+void ranking_update(Provider prov, uint64_t latency_us, int found);
+
+/* Sorts specified lyrics providers by their expected cost, which is the
+ * expected latency divided by the probability of finding lyrics. Trying
+ * providers in this order minimizes expected time to the first hit. */
+void ranking_sort(Provider *order, size_t size);
+
+/* Returns expected cost of the specified provider in milliseconds. */
+double ranking_cost(Provider prov);
+
+/* Saves ranking to the cache, so it survives restarts. */
+int ranking_save(void);
+
+#endif
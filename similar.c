@@ -20,8 +20,7 @@
 #include "similar.h"
 
 /* Parses XML from lastfm and forms list of similar artists. */
-static int
-parse_similar(const char *content, SimilarInfo **similar, size_t *size) {
+int parse_similar(const char *content, SimilarInfo **similar, size_t *size) {
     
     xmlDocPtr doc = NULL;
     if (init_doc_obj(content, XML, &doc) == -1)
@@ -112,13 +111,15 @@ int fetch_similar_artists(const char *artist, SimilarInfo **similar, size_t *siz
         return -1;
     
     char *raw_page = NULL;
-    if (retrieve_txt_content(url, &raw_page) == -1) {
+    int res = retrieve_txt_content(url, LASTFM_SIMILAR, NULL, &raw_page);
+    if (res != 0) {
         free(url);
-        return -1;
+        return res;
     }
     free(url);
     
     if (parse_similar(raw_page, similar, size) == -1) {
+        stats_parse_failure(LASTFM_SIMILAR);
         free(raw_page);
         return -1;
     }
@@ -29,6 +29,9 @@
 /* XPath expressions. */
 #define SIM_EXP "/lfm/similarartists/artist"
 
+/* Parses XML from lastfm and forms list of similar artists. */
+int parse_similar(const char *content, SimilarInfo **similar, size_t *size);
+
 /* Frees list of similar artists */
 void free_sim_list(SimilarInfo *similar, size_t size);
 
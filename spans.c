@@ -0,0 +1,200 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <time.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "spans.h"
+
+#define MAX_STATS 64
+
+/* Recorded span. Sequence number is odd while the slot is being written
+ * and equals to 2 * (index + 1) when the span with that index is stored. */
+typedef struct {
+    uint64_t seq;
+    const char *name;
+    const char *cat;
+    uint64_t begin;
+    uint64_t end;
+    uint32_t tid;
+} Span;
+
+/* Aggregated durations of the spans with the same name. */
+typedef struct {
+    const char *name;
+    const char *cat;
+    size_t count;
+    uint64_t total;
+    uint64_t max;
+} SpanStats;
+
+static int enabled;
+static uint64_t head;
+static uint64_t logged;
+static Span ring[SPANS_RING_SIZE];
+static __thread uint32_t thread_id;
+
+static uint64_t
+now_ns(void) {
+
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Copies a consistent snapshot of the span with specified index.
+ * Returns -1 if the slot was already overwritten or isn't finished yet. */
+static int
+read_span(uint64_t idx, Span *span) {
+
+    Span *slot = &ring[idx & (SPANS_RING_SIZE - 1)];
+    uint64_t seq = 2 * (idx + 1);
+
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq)
+        return -1;
+
+    span->name = slot->name;
+    span->cat = slot->cat;
+    span->begin = slot->begin;
+    span->end = slot->end;
+    span->tid = slot->tid;
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq ? 0 : -1;
+}
+
+/* Enables or disables spans recording. */
+void spans_set_enabled(int value) {
+    __atomic_store_n(&enabled, value, __ATOMIC_RELAXED);
+}
+
+/* Starts a span. Returns 0 if recording is disabled. */
+uint64_t span_begin(void) {
+
+    if (!__atomic_load_n(&enabled, __ATOMIC_RELAXED))
+        return 0;
+
+    return now_ns();
+}
+
+/* Finishes a span and stores it in the ring buffer. */
+void span_end(uint64_t begin, const char *name, const char *cat) {
+
+    if (begin == 0)
+        return;
+
+    uint64_t end = now_ns();
+    if (thread_id == 0)
+        thread_id = (uint32_t) syscall(SYS_gettid);
+
+    /* Each writer owns its slot after the increment, readers detect
+     * overwritten or incomplete slots by the sequence number. */
+    uint64_t idx = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+    Span *slot = &ring[idx & (SPANS_RING_SIZE - 1)];
+
+    __atomic_store_n(&slot->seq, 2 * idx + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->name = name;
+    slot->cat = cat;
+    slot->begin = begin;
+    slot->end = end;
+    slot->tid = thread_id;
+
+    __atomic_store_n(&slot->seq, 2 * (idx + 1), __ATOMIC_RELEASE);
+}
+
+/* Exports recorded spans as Chrome trace-event JSON. */
+int spans_export_json(const char *file) {
+
+    FILE *out = fopen(file, "w");
+    if (!out)
+        return -1;
+
+    uint64_t last = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    uint64_t first = last > SPANS_RING_SIZE ? last - SPANS_RING_SIZE : 0;
+
+    fprintf(out, "{\"traceEvents\":[\n");
+
+    int sep = 0;
+    for (uint64_t i = first; i < last; ++i) {
+        Span span = {0};
+        if (read_span(i, &span) == -1)
+            continue;
+
+        fprintf(out, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,"
+                "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", sep ? ",\n" : "",
+                span.name, span.cat, (int) getpid(), span.tid, span.begin / 1e3,
+                (span.end - span.begin) / 1e3);
+        sep = 1;
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    if (fclose(out) != 0)
+        return -1;
+    return 0;
+}
+
+/* Writes count, average and maximum duration of each span recorded
+ * since the previous call. */
+void spans_log_stats(FILE *out) {
+
+    uint64_t last = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    uint64_t first = __atomic_exchange_n(&logged, last, __ATOMIC_RELAXED);
+    if (last - first > SPANS_RING_SIZE)
+        first = last - SPANS_RING_SIZE;
+
+    size_t size = 0;
+    SpanStats stats[MAX_STATS];
+
+    for (uint64_t i = first; i < last; ++i) {
+        Span span = {0};
+        if (read_span(i, &span) == -1)
+            continue;
+
+        size_t j = 0;
+        while (j < size && (strcmp(stats[j].name, span.name) != 0 ||
+                            strcmp(stats[j].cat, span.cat) != 0))
+            ++j;
+
+        if (j == size) {
+            if (size == MAX_STATS)
+                continue;
+
+            memset(&stats[size], 0, sizeof(SpanStats));
+            stats[size].name = span.name;
+            stats[size].cat = span.cat;
+            ++size;
+        }
+
+        uint64_t dur = span.end - span.begin;
+        stats[j].total += dur;
+        ++stats[j].count;
+        if (dur > stats[j].max)
+            stats[j].max = dur;
+    }
+
+    for (size_t j = 0; j < size; ++j) {
+        fprintf(out, "infobar: %-8s %-24s count %6zu  avg %9.3f ms  max %9.3f ms\n",
+                stats[j].cat, stats[j].name, stats[j].count,
+                stats[j].total / 1e6 / stats[j].count, stats[j].max / 1e6);
+    }
+}
@@ -0,0 +1,55 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_SPANS_HEADER
+#define INFOBAR_SPANS_HEADER
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Number of the most recent spans kept in the ring buffer. Must be a power of 2. */
+#define SPANS_RING_SIZE 8192
+
+/* Span categories. */
+#define SPAN_NET "net"
+#define SPAN_PARSE "parse"
+#define SPAN_DISK "disk"
+#define SPAN_TEXT "text"
+#define SPAN_PROVIDER "provider"
+#define SPAN_WORKER "worker"
+#define SPAN_GUI "gui"
+
+/* Enables or disables spans recording. */
+void spans_set_enabled(int enabled);
+
+/* Starts a span. Returns 0 if recording is disabled. */
+uint64_t span_begin(void);
+
+/* Finishes a span started by span_begin and stores it in the ring buffer.
+ * Name and category must be string literals, as only pointers are stored. */
+void span_end(uint64_t begin, const char *name, const char *cat);
+
+/* Exports recorded spans as Chrome trace-event JSON. */
+int spans_export_json(const char *file);
+
+/* Writes count, average and maximum duration of each span recorded
+ * since the previous call. */
+void spans_log_stats(FILE *out);
+
+#endif
@@ -0,0 +1,300 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stats.h"
+#include "breaker.h"
+
+#define CACHE_TYPES 2
+#define CACHE_STATES 3
+
+static const char *provider_names[PROVIDERS_COUNT] = {
+    "lyricswikia",
+    "lyricsmania",
+    "lyricstime",
+    "megalyrics",
+    "script",
+    "lastfm bio",
+    "lastfm image",
+    "lastfm similar",
+};
+
+/* Sites the providers fetch from. Providers of the same site share
+ * the settings, e.g. timeouts. */
+static const char *provider_sites[PROVIDERS_COUNT] = {
+    "lyricswikia",
+    "lyricsmania",
+    "lyricstime",
+    "megalyrics",
+    "script",
+    "lastfm",
+    "lastfm",
+    "lastfm",
+};
+
+static ProviderStats providers[PROVIDERS_COUNT];
+static uint64_t caches[CACHE_TYPES][CACHE_STATES];
+
+static void
+counter_add(uint64_t *counter, uint64_t value) {
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static uint64_t
+counter_get(const uint64_t *counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/* Returns index of the histogram bucket for the specified latency. */
+static size_t
+bucket_index(uint64_t us) {
+
+    if (us >= (1ULL << STATS_MAX_BITS))
+        return STATS_BUCKETS - 1;
+
+    if (us < (1 << STATS_SUB_BITS))
+        return us;
+
+    int msb = 63 - __builtin_clzll(us);
+    int shift = msb - STATS_SUB_BITS;
+    return ((shift + 1) << STATS_SUB_BITS) + ((us >> shift) - (1 << STATS_SUB_BITS));
+}
+
+/* Returns the lowest latency, which falls into the specified bucket. */
+static uint64_t
+bucket_value(size_t idx) {
+
+    if (idx < (2 << STATS_SUB_BITS))
+        return idx;
+
+    int shift = (idx >> STATS_SUB_BITS) - 1;
+    uint64_t sub = (idx & ((1 << STATS_SUB_BITS) - 1)) + (1 << STATS_SUB_BITS);
+    return sub << shift;
+}
+
+/* Returns percentage of the specified part of the total. */
+static double
+percent(uint64_t part, uint64_t total) {
+    return total ? 100.0 * part / total : 0.0;
+}
+
+/* Returns printable name of the specified provider. */
+const char *provider_name(Provider prov) {
+    return provider_names[prov];
+}
+
+/* Returns name of the site the specified provider fetches from. */
+const char *provider_site(Provider prov) {
+    return provider_sites[prov];
+}
+
+/* Returns monotonic time in nanoseconds to measure attempt latency. */
+uint64_t stats_now(void) {
+
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Records an attempt to fetch content from the specified provider. */
+void stats_attempt(Provider prov, uint64_t begin, int found) {
+
+    ProviderStats *st = &providers[prov];
+    uint64_t us = (stats_now() - begin) / 1000;
+
+    counter_add(&st->attempts, 1);
+    counter_add(found ? &st->hits : &st->misses, 1);
+    __atomic_fetch_add(&st->latency[bucket_index(us)], 1, __ATOMIC_RELAXED);
+
+    uint64_t max = counter_get(&st->latency_max);
+    while (us > max && !__atomic_compare_exchange_n(&st->latency_max, &max, us,
+                0, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/* Records bytes received from the specified provider. */
+void stats_bytes(Provider prov, size_t bytes) {
+    counter_add(&providers[prov].bytes, bytes);
+}
+
+/* Records failure to retrieve content from the specified provider. */
+void stats_error(Provider prov) {
+    counter_add(&providers[prov].errors, 1);
+}
+
+/* Records failure to parse content received from the specified provider. */
+void stats_parse_failure(Provider prov) {
+    counter_add(&providers[prov].parse_failures, 1);
+}
+
+/* Records timed out request to the specified provider. */
+void stats_timeout(Provider prov) {
+    counter_add(&providers[prov].timeouts, 1);
+}
+
+/* Records request rejected by the circuit breaker of the specified provider. */
+void stats_rejected(Provider prov) {
+    counter_add(&providers[prov].rejected, 1);
+}
+
+/* Records result of the cache lookup. */
+void stats_cache(CacheType type, CacheState state) {
+    counter_add(&caches[type][state], 1);
+}
+
+/* Copies current counters of the specified provider. */
+void stats_get(Provider prov, ProviderStats *stats) {
+
+    ProviderStats *st = &providers[prov];
+
+    stats->attempts = counter_get(&st->attempts);
+    stats->hits = counter_get(&st->hits);
+    stats->misses = counter_get(&st->misses);
+    stats->errors = counter_get(&st->errors);
+    stats->parse_failures = counter_get(&st->parse_failures);
+    stats->timeouts = counter_get(&st->timeouts);
+    stats->rejected = counter_get(&st->rejected);
+    stats->bytes = counter_get(&st->bytes);
+    stats->latency_max = counter_get(&st->latency_max);
+
+    for (size_t i = 0; i < STATS_BUCKETS; ++i)
+        stats->latency[i] = __atomic_load_n(&st->latency[i], __ATOMIC_RELAXED);
+}
+
+/* Returns latency in microseconds below which the specified fraction
+ * of attempts were finished. */
+uint64_t stats_percentile(const ProviderStats *stats, double fraction) {
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < STATS_BUCKETS; ++i)
+        total += stats->latency[i];
+
+    if (total == 0)
+        return 0;
+
+    uint64_t rank = fraction * total + 0.5;
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < STATS_BUCKETS; ++i) {
+        seen += stats->latency[i];
+        if (seen >= rank) {
+            /* Reporting the highest value of the bucket, but never
+             * more than the maximum value really seen. */
+            uint64_t value = i + 1 < STATS_BUCKETS ? bucket_value(i + 1) - 1 : bucket_value(i);
+            return value < stats->latency_max ? value : stats->latency_max;
+        }
+    }
+    return stats->latency_max;
+}
+
+/* Writes human-readable report of all counters. */
+void stats_write(FILE *out) {
+
+    fprintf(out, "%-15s %8s %8s %8s %8s %8s %8s %8s %10s %9s %9s %9s %9s  %s\n",
+            "provider", "attempts", "hit %", "misses", "errors", "parse",
+            "timeouts", "rejected", "KiB", "p50 ms", "p90 ms", "p99 ms", "max ms", "breaker");
+
+    for (int i = 0; i < PROVIDERS_COUNT; ++i) {
+        ProviderStats st = {0};
+        stats_get(i, &st);
+
+        fprintf(out, "%-15s %8llu %8.1f %8llu %8llu %8llu %8llu %8llu %10.1f %9.1f %9.1f %9.1f %9.1f  %s\n",
+                provider_names[i], (unsigned long long) st.attempts,
+                percent(st.hits, st.attempts), (unsigned long long) st.misses,
+                (unsigned long long) st.errors, (unsigned long long) st.parse_failures,
+                (unsigned long long) st.timeouts, (unsigned long long) st.rejected,
+                st.bytes / 1024.0, stats_percentile(&st, 0.5) / 1e3,
+                stats_percentile(&st, 0.9) / 1e3, stats_percentile(&st, 0.99) / 1e3,
+                st.latency_max / 1e3, breaker_state_name(breaker_state(i)));
+    }
+
+    fprintf(out, "\n%-15s %8s %8s %8s %8s\n", "cache", "lookups", "hit %", "misses", "stale");
+
+    static const char *cache_names[CACHE_TYPES] = {"lyrics", "biography"};
+    for (int i = 0; i < CACHE_TYPES; ++i) {
+        uint64_t hits = counter_get(&caches[i][CACHE_HIT]);
+        uint64_t misses = counter_get(&caches[i][CACHE_MISS]);
+        uint64_t stale = counter_get(&caches[i][CACHE_STALE]);
+        uint64_t total = hits + misses + stale;
+
+        fprintf(out, "%-15s %8llu %8.1f %8llu %8llu\n", cache_names[i],
+                (unsigned long long) total, percent(hits, total),
+                (unsigned long long) misses, (unsigned long long) stale);
+    }
+}
+
+/* Formats human-readable report of all counters. */
+int stats_format(char **report) {
+
+    size_t size = 0;
+    FILE *out = open_memstream(report, &size);
+    if (!out)
+        return -1;
+
+    stats_write(out);
+    if (fclose(out) != 0) {
+        free(*report);
+        *report = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/* Writes human-readable report of all counters to the specified file. */
+int stats_dump(const char *file) {
+
+    FILE *out = fopen(file, "w");
+    if (!out)
+        return -1;
+
+    stats_write(out);
+    if (fclose(out) != 0)
+        return -1;
+    return 0;
+}
+
+/* Resets all counters. */
+void stats_reset(void) {
+
+    for (int i = 0; i < PROVIDERS_COUNT; ++i) {
+        ProviderStats *st = &providers[i];
+
+        __atomic_store_n(&st->attempts, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->hits, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->misses, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->errors, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->parse_failures, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->timeouts, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->rejected, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->bytes, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&st->latency_max, 0, __ATOMIC_RELAXED);
+
+        for (size_t j = 0; j < STATS_BUCKETS; ++j)
+            __atomic_store_n(&st->latency[j], 0, __ATOMIC_RELAXED);
+    }
+
+    for (int i = 0; i < CACHE_TYPES; ++i) {
+        for (int j = 0; j < CACHE_STATES; ++j)
+            __atomic_store_n(&caches[i][j], 0, __ATOMIC_RELAXED);
+    }
+}
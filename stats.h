@@ -0,0 +1,100 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_STATS_HEADER
+#define INFOBAR_STATS_HEADER
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "types.h"
+
+/* Latency histograms have 2^STATS_SUB_BITS linear sub-buckets in each power
+ * of 2 range of microseconds, so every bucket is within 12.5% of its value. */
+#define STATS_SUB_BITS 3
+#define STATS_MAX_BITS 32
+#define STATS_BUCKETS ((STATS_MAX_BITS - STATS_SUB_BITS + 1) << STATS_SUB_BITS)
+
+/* Counters of a single content provider. Attempt is either a hit or a miss,
+ * misses are further split into network errors, parse failures and timeouts.
+ * Requests rejected by the open circuit breaker aren't attempts and are
+ * only counted as rejected. */
+typedef struct {
+    uint64_t attempts;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t errors;
+    uint64_t parse_failures;
+    uint64_t timeouts;
+    uint64_t rejected;
+    uint64_t bytes;
+    uint64_t latency_max;
+    uint32_t latency[STATS_BUCKETS];
+} ProviderStats;
+
+/* Returns printable name of the specified provider. */
+const char *provider_name(Provider prov);
+
+/* Returns name of the site the specified provider fetches from. */
+const char *provider_site(Provider prov);
+
+/* Returns monotonic time in nanoseconds to measure attempt latency. */
+uint64_t stats_now(void);
+
+/* Records an attempt to fetch content from the specified provider. */
+void stats_attempt(Provider prov, uint64_t begin, int found);
+
+/* Records bytes received from the specified provider. */
+void stats_bytes(Provider prov, size_t bytes);
+
+/* Records failure to retrieve content from the specified provider. */
+void stats_error(Provider prov);
+
+/* Records failure to parse content received from the specified provider. */
+void stats_parse_failure(Provider prov);
+
+/* Records timed out request to the specified provider. */
+void stats_timeout(Provider prov);
+
+/* Records request rejected by the circuit breaker of the specified provider. */
+void stats_rejected(Provider prov);
+
+/* Records result of the cache lookup. */
+void stats_cache(CacheType type, CacheState state);
+
+/* Copies current counters of the specified provider. */
+void stats_get(Provider prov, ProviderStats *stats);
+
+/* Returns latency in microseconds below which the specified fraction
+ * of attempts were finished. */
+uint64_t stats_percentile(const ProviderStats *stats, double fraction);
+
+/* Writes human-readable report of all counters. */
+void stats_write(FILE *out);
+
+/* Formats human-readable report of all counters. */
+int stats_format(char **report);
+
+/* Writes human-readable report of all counters to the specified file. */
+int stats_dump(const char *file);
+
+/* Resets all counters. */
+void stats_reset(void);
+
+#endif
@@ -20,6 +20,8 @@
 #ifndef TYPES_HEADER
 #define TYPES_HEADER
 
+#include <stddef.h>
+
 /* Custom types. */
 typedef enum {
     HTML = 0,
@@ -31,6 +33,24 @@ typedef enum {
     BIO = 1,
 } CacheType;
 
+typedef enum {
+    CACHE_HIT = 0,
+    CACHE_MISS = 1,
+    CACHE_STALE = 2,
+} CacheState;
+
+typedef enum {
+    LYRICSWIKIA = 0,
+    LYRICSMANIA = 1,
+    LYRICSTIME = 2,
+    MEGALYRICS = 3,
+    LYRICS_SCRIPT = 4,
+    LASTFM_BIO = 5,
+    LASTFM_IMAGE = 6,
+    LASTFM_SIMILAR = 7,
+    PROVIDERS_COUNT = 8,
+} Provider;
+
 typedef enum {
     NAME = 0,
     MATCH = 1,
@@ -42,10 +62,55 @@ typedef struct {
     float height;
 } Res;
 
+/* Size of the match value formatted as percentage. */
+#define PERC_SIZE 10
+
 typedef struct {
     char *name;
     char *match;
     char *url;
+    /* Match value as percentage, formatted by the worker. */
+    char perc[PERC_SIZE];
 } SimilarInfo;
 
+/* Validators of the cached response, which are sent back to the
+ * provider to check if the response has changed. */
+typedef struct {
+    Provider prov;
+    char *url;
+    char *etag;
+    char *last_modified;
+    /* Set if the provider confirmed, that the response hasn't changed. */
+    int not_modified;
+} Validators;
+
+/* Snapshot of the track's metadata. Strings are stored in the same
+ * allocation as the snapshot, so it's freed at once. */
+typedef struct {
+    const char *artist;
+    const char *title;
+    const char *album;
+    const char *album_artist;
+    const char *mb_artist_id;
+    const char *mb_track_id;
+    float duration;
+} TrackMeta;
+
+/* Sizes of artist's image offered by lastfm. */
+typedef enum {
+    IMG_SMALL = 0,
+    IMG_MEDIUM = 1,
+    IMG_LARGE = 2,
+    IMG_EXTRALARGE = 3,
+    IMG_MEGA = 4,
+    IMG_SIZES_COUNT = 5,
+} ImgSize;
+
+/* Receives the pieces of the downloaded image as they arrive,
+ * while the image is being saved to the cache. */
+typedef struct {
+    void (*write)(const char *data, size_t size, void *ctx);
+    void *ctx;
+} ImgSink;
+
 #endif
@@ -19,26 +19,98 @@
 
 #include "ui.h"
 
+/* Infobar widget. */
+GtkWidget *infobar;
+
 static GtkWidget *infobar_tabs;
 static GtkWidget *infobar_toggles;
 
 static GtkWidget *lyr_toggle;
 static GtkWidget *bio_toggle;
 static GtkWidget *sim_toggle;
+static GtkWidget *stats_toggle;
 static GtkWidget *dlt_toggle;
 
 static GtkWidget *lyr_tab;
 static GtkWidget *bio_tab;
 static GtkWidget *sim_tab;
+static GtkWidget *stats_tab;
 
 static GtkWidget *lyr_view;
+static GtkWidget *bio_view;
 static GtkWidget *img_frame;
 static GtkWidget *bio_image;
 static GtkWidget *sim_list;
 static GdkPixbuf *bio_pixbuf;
 
+/* Artist's image, scaled for the allocation of the image area. */
+static cairo_surface_t *bio_surface;
+static int surface_aw;
+static int surface_ah;
+
+/* Rescales artist's image, when the image area stops resizing. */
+static guint rescale_timer;
+
+/* Size of the artist's image area in device pixels. Updated on
+ * the GUI thread, read by the workers. */
+static int bio_image_width;
+static int bio_image_height;
+
 static GtkTextBuffer *lyr_buffer;
 static GtkTextBuffer *bio_buffer;
+static GtkTextBuffer *stats_buffer;
+
+/* Text, which is currently shown in the "Lyrics" and "Biography" tabs. */
+static char *lyr_shown;
+static char *bio_shown;
+
+static guint stats_timer;
+
+/* View, which is shown to the user. Updated on the GUI thread,
+ * read by the workers. */
+static int visible_view = VIEW_NONE;
+
+/* Publishes, which view is shown on the specified notebook page. */
+static void
+set_visible_page(GtkWidget *page) {
+
+    InfobarView view = VIEW_NONE;
+    if (page == lyr_tab)
+        view = VIEW_LYRICS;
+    else if (page == bio_tab)
+        view = VIEW_BIO;
+    else if (page == sim_tab)
+        view = VIEW_SIMILAR;
+
+    __atomic_store_n(&visible_view, view, __ATOMIC_RELAXED);
+}
+
+/* Called when the notebook switches pages, including the switches
+ * caused by hiding tabs in the configuration. */
+static void
+infobar_page_switched(GtkNotebook *notebook, gpointer page, guint num, gpointer data) {
+
+    if (gtk_widget_get_mapped(infobar)) {
+        set_visible_page(gtk_notebook_get_nth_page(notebook, num));
+        infobar_reschedule_fetches();
+    }
+}
+
+/* Called when the infobar is shown, for example when the layout
+ * containing it is expanded. */
+static void
+infobar_mapped(GtkWidget *widget, gpointer data) {
+
+    GtkNotebook *notebook = GTK_NOTEBOOK(infobar_tabs);
+    set_visible_page(gtk_notebook_get_nth_page(notebook, gtk_notebook_get_current_page(notebook)));
+    infobar_reschedule_fetches();
+}
+
+/* Called when the infobar is hidden, nothing is shown since then. */
+static void
+infobar_unmapped(GtkWidget *widget, gpointer data) {
+    __atomic_store_n(&visible_view, VIEW_NONE, __ATOMIC_RELAXED);
+}
 
 /* Called when user switches the infobar tabs. When the toggle was clicked,
  * appropriate tab should be selected. */
@@ -50,6 +122,105 @@ infobar_tab_changed(GtkToggleButton *toggle, GtkWidget *widget) {
     return FALSE;
 }
 
+/* Returns the number of device pixels per logical pixel of the widget. */
+static int
+get_scale_factor(GtkWidget *widget) {
+
+#if GTK_CHECK_VERSION(3, 10, 0)
+    return gtk_widget_get_scale_factor(widget);
+#else
+    return 1;
+#endif
+}
+
+/* Called when the artist's image area gets its size. */
+static void
+bio_image_allocated(GtkWidget *image, GtkAllocation *alloc, gpointer data) {
+
+    int scale = get_scale_factor(image);
+    __atomic_store_n(&bio_image_width, alloc->width * scale, __ATOMIC_RELAXED);
+    __atomic_store_n(&bio_image_height, alloc->height * scale, __ATOMIC_RELAXED);
+}
+
+/* Returns the allocation of the artist's image area. */
+static void
+get_bio_image_size(GtkWidget *image, int *aw, int *ah) {
+
+#if GTK_CHECK_VERSION(3, 0, 0)
+    *aw = gtk_widget_get_allocated_width(image);
+    *ah = gtk_widget_get_allocated_height(image);
+#else
+    *aw = image->allocation.width;
+    *ah = image->allocation.height;
+#endif
+    /* This is a workaround which prevents application
+     * hanging when we make infobar width == 0 */
+    if (*aw < 10) *aw = 10;
+    if (*ah < 10) *ah = 10;
+}
+
+/* Disposes the surface with the scaled artist's image. */
+static void
+free_bio_surface(void) {
+
+    if (bio_surface) {
+        cairo_surface_destroy(bio_surface);
+        bio_surface = NULL;
+    }
+}
+
+/* Scales artist's image to fit the specified allocation and keeps
+ * it as a surface, which is painted as is on every expose. */
+static void
+rescale_bio_image(int aw, int ah) {
+
+    free_bio_surface();
+
+    int scale = get_scale_factor(bio_image);
+    int ww = gdk_pixbuf_get_width(bio_pixbuf);
+    int wh = gdk_pixbuf_get_height(bio_pixbuf);
+
+    Res new_res = {0};
+    find_new_resolution(ww, wh, aw * scale, ah * scale, &new_res);
+
+    /* Usually the image was already scaled by the worker. */
+    GdkPixbuf *sld = NULL;
+    if (ww == (int) new_res.width && wh == (int) new_res.height)
+        sld = g_object_ref(bio_pixbuf);
+    else
+        sld = gdk_pixbuf_scale_simple(bio_pixbuf, new_res.width,
+                new_res.height, GDK_INTERP_BILINEAR);
+
+    if (sld) {
+        bio_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                gdk_pixbuf_get_width(sld), gdk_pixbuf_get_height(sld));
+
+        cairo_t *cr = cairo_create(bio_surface);
+        gdk_cairo_set_source_pixbuf(cr, sld, 0, 0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+
+        g_object_unref(sld);
+    }
+    surface_aw = aw;
+    surface_ah = ah;
+}
+
+/* Called when the image area wasn't resized for a while to replace
+ * stretched image with the properly scaled one. */
+static gboolean
+bio_image_resized(gpointer data) {
+
+    rescale_timer = 0;
+    if (bio_pixbuf) {
+        int aw = 0, ah = 0;
+        get_bio_image_size(bio_image, &aw, &ah);
+        rescale_bio_image(aw, ah);
+        gtk_widget_queue_draw(bio_image);
+    }
+    return FALSE;
+}
+
 /* Called when user resizes artist's image on "Biography" tab to redraw
  * the image with the new size. */
 static gboolean
@@ -61,30 +232,33 @@ bio_image_expose(GtkWidget *image, GdkEventExpose *event, gpointer data) {
 
     if (bio_pixbuf) {
 
-        float ww = gdk_pixbuf_get_width(bio_pixbuf);
-        float wh = gdk_pixbuf_get_height(bio_pixbuf);
-#if GTK_CHECK_VERSION(3, 0, 0)
-        float aw = gtk_widget_get_allocated_width(image);
-        float ah = gtk_widget_get_allocated_height(image);
-#else
-        float aw = image->allocation.width;
-        float ah = image->allocation.height;
-#endif
-        /* This is a workaround which prevents application
-         * hanging when we make infobar width == 0 */
-        if (aw < 10) aw = 10;
-        if (ah < 10) ah = 10;
+        int aw = 0, ah = 0;
+        get_bio_image_size(image, &aw, &ah);
+
+        /* New image is scaled at once. While the area is being resized,
+         * the scaled image is just stretched, and it's scaled again
+         * only when resizing stops. */
+        if (!bio_surface) {
+            rescale_bio_image(aw, ah);
+        } else if (aw != surface_aw || ah != surface_ah) {
+            if (rescale_timer)
+                g_source_remove(rescale_timer);
+            rescale_timer = gdk_threads_add_timeout(BIO_IMAGE_RESCALE_DELAY, bio_image_resized, NULL);
+        }
 
-        Res new_res = {0};
-        find_new_resolution(ww, wh, aw, ah, &new_res);
+        if (bio_surface) {
 
-        int pos_x = (aw - new_res.width) / 2;
-        int pos_y = (ah - new_res.height) / 2;
+            Res new_res = {0};
+            find_new_resolution(gdk_pixbuf_get_width(bio_pixbuf), gdk_pixbuf_get_height(bio_pixbuf),
+                    aw, ah, &new_res);
 
-        GdkPixbuf *sld = gdk_pixbuf_scale_simple(bio_pixbuf, new_res.width,
-                new_res.height, GDK_INTERP_BILINEAR);
+            int width = new_res.width;
+            int height = new_res.height;
+            int pos_x = (aw - width) / 2;
+            int pos_y = (ah - height) / 2;
 
-        if (sld) {
+            int sw = cairo_image_surface_get_width(bio_surface);
+            int sh = cairo_image_surface_get_height(bio_surface);
 #if GTK_CHECK_VERSION(3, 0, 0)
             GdkWindow *window = gtk_widget_get_window(image);
             cairo_t *cr = gdk_cairo_create(window);
@@ -92,16 +266,61 @@ bio_image_expose(GtkWidget *image, GdkEventExpose *event, gpointer data) {
             cairo_t *cr = gdk_cairo_create(image->window);
 #endif
             if (cr) {
-                gdk_cairo_set_source_pixbuf(cr, sld, pos_x, pos_y);
+                cairo_translate(cr, pos_x, pos_y);
+                if (sw != width || sh != height)
+                    cairo_scale(cr, (double) width / sw, (double) height / sh);
+
+                cairo_set_source_surface(cr, bio_surface, 0, 0);
+                cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_FAST);
                 cairo_paint(cr);
                 cairo_destroy(cr);
             }
-            g_object_unref(sld);
         }
     }
     return FALSE;
 }
 
+/* Updates "Stats" tab with the current provider and cache counters. */
+static void
+update_stats_view(void) {
+
+    char *report = NULL;
+    if (stats_format(&report) == -1)
+        return;
+
+    GtkTextIter begin = {0}, end = {0};
+
+    gtk_text_buffer_get_iter_at_line(stats_buffer, &begin, 0);
+    gtk_text_buffer_get_end_iter(stats_buffer, &end);
+    gtk_text_buffer_delete(stats_buffer, &begin, &end);
+
+    gtk_text_buffer_insert_with_tags_by_name(GTK_TEXT_BUFFER(stats_buffer),
+            &begin, report, -1, "mono", NULL);
+    free(report);
+}
+
+/* Called when user switches to the "Stats" tab to show fresh counters. */
+static gboolean
+stats_tab_toggled(GtkToggleButton *toggle, gpointer data) {
+
+    if (gtk_toggle_button_get_active(toggle))
+        update_stats_view();
+    return FALSE;
+}
+
+/* Periodically refreshes "Stats" tab while it's shown. */
+static gboolean
+stats_tab_refresh(gpointer data) {
+
+    int index = gtk_notebook_page_num(GTK_NOTEBOOK(infobar_tabs), stats_tab);
+    if (gtk_widget_get_visible(stats_tab) &&
+        gtk_notebook_get_current_page(GTK_NOTEBOOK(infobar_tabs)) == index)
+    {
+        update_stats_view();
+    }
+    return TRUE;
+}
+
 /* Disables any keyboard events in the "Similar" list. */
 static gboolean
 sim_list_dis_key(GtkWidget *widget, GdkEvent *event, gpointer data) {
@@ -153,15 +372,12 @@ delete_cache_clicked(void) {
         DB_playItem_t *track = deadbeef->streamer_get_playing_track();
         if (track) {
 
-            char *artist = NULL, *title = NULL;
-
-            if (get_artist_and_title_info(track, &artist, &title) == 0) {
-                del_lyr_cache(artist, title);
-                del_bio_cache(artist);
-
-                free(artist);
-                free(title);
+            TrackMeta *meta = get_track_meta(track);
+            if (meta && meta->title) {
+                del_lyr_cache(meta->artist, meta->title);
+                del_bio_cache(meta->artist);
             }
+            free(meta);
             deadbeef->pl_item_unref(track);
         }
         break;
@@ -220,6 +436,45 @@ create_dlt_btn(void) {
     g_signal_connect(dlt_toggle, "clicked", G_CALLBACK(delete_cache_clicked), NULL);
 }
 
+/* Creates "Stats" tab. Should be called after the "Similar" tab
+ * was created. */
+static void
+create_stats_tab(void) {
+
+    stats_toggle = gtk_radio_button_new_with_label_from_widget(
+            GTK_RADIO_BUTTON(sim_toggle), "Stats");
+
+    gtk_toggle_button_set_mode(GTK_TOGGLE_BUTTON(stats_toggle), FALSE);
+
+    stats_tab = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(stats_tab),
+            GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+
+    GtkWidget *stats_view = gtk_text_view_new();
+    gtk_text_view_set_editable(GTK_TEXT_VIEW(stats_view), FALSE);
+    gtk_text_view_set_wrap_mode(GTK_TEXT_VIEW(stats_view), GTK_WRAP_NONE);
+    gtk_text_view_set_cursor_visible(GTK_TEXT_VIEW(stats_view), FALSE);
+    gtk_widget_set_can_focus(stats_view, FALSE);
+
+    gtk_container_add(GTK_CONTAINER(stats_tab), stats_view);
+
+    stats_buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(stats_view));
+
+    gtk_text_buffer_create_tag(GTK_TEXT_BUFFER(stats_buffer),
+            "mono", "family", "monospace", NULL);
+
+    g_signal_connect(stats_toggle, "toggled", G_CALLBACK(infobar_tab_changed), stats_tab);
+    g_signal_connect(stats_toggle, "toggled", G_CALLBACK(stats_tab_toggled), NULL);
+
+    stats_timer = gdk_threads_add_timeout_seconds(STATS_REFRESH_PERIOD, stats_tab_refresh, NULL);
+}
+
+/* Creates an empty model of the "Similar" list. */
+static GtkListStore *
+new_sim_store(void) {
+    return gtk_list_store_new(3, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+}
+
 /* Creates "Similar" tab. Should be called after the "Biography" tab
  * was created. */
 static void
@@ -234,10 +489,10 @@ create_sim_tab(void) {
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(sim_tab),
             GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
 
-    GtkListStore *sim_store = gtk_list_store_new(3, G_TYPE_STRING,
-            G_TYPE_STRING, G_TYPE_STRING);
+    GtkListStore *sim_store = new_sim_store();
 
     sim_list = gtk_tree_view_new_with_model(GTK_TREE_MODEL(sim_store));
+    g_object_unref(sim_store);
     gtk_tree_view_set_grid_lines(GTK_TREE_VIEW(sim_list), GTK_TREE_VIEW_GRID_LINES_BOTH);
 
     GtkCellRenderer *name_renderer = gtk_cell_renderer_text_new();
@@ -282,7 +537,7 @@ create_bio_tab(void) {
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(bio_scroll),
             GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
 
-    GtkWidget *bio_view = gtk_text_view_new();
+    bio_view = gtk_text_view_new();
 
     gtk_text_view_set_editable(GTK_TEXT_VIEW(bio_view), FALSE);
     gtk_text_view_set_wrap_mode(GTK_TEXT_VIEW(bio_view), GTK_WRAP_WORD);
@@ -311,6 +566,7 @@ create_bio_tab(void) {
 #else
     g_signal_connect(bio_image, "expose-event", G_CALLBACK(bio_image_expose), NULL);
 #endif
+    g_signal_connect(bio_image, "size-allocate", G_CALLBACK(bio_image_allocated), NULL);
     g_signal_connect(bio_toggle, "toggled", G_CALLBACK(infobar_tab_changed), bio_tab);
 
     int handle_width = 0;
@@ -378,24 +634,31 @@ void create_infobar(void) {
     create_lyr_tab();
     create_bio_tab();
     create_sim_tab();
+    create_stats_tab();
     create_dlt_btn();
 
     gtk_box_pack_start(GTK_BOX(infobar_toggles), lyr_toggle, FALSE, FALSE, 1);
     gtk_box_pack_start(GTK_BOX(infobar_toggles), bio_toggle, FALSE, FALSE, 1);
     gtk_box_pack_start(GTK_BOX(infobar_toggles), sim_toggle, FALSE, FALSE, 1);
+    gtk_box_pack_start(GTK_BOX(infobar_toggles), stats_toggle, FALSE, FALSE, 1);
     gtk_box_pack_start(GTK_BOX(infobar_toggles), dlt_toggle, FALSE, FALSE, 1);
 
     gtk_notebook_append_page(GTK_NOTEBOOK(infobar_tabs), lyr_tab, NULL);
     gtk_notebook_append_page(GTK_NOTEBOOK(infobar_tabs), bio_tab, NULL);
     gtk_notebook_append_page(GTK_NOTEBOOK(infobar_tabs), sim_tab, NULL);
+    gtk_notebook_append_page(GTK_NOTEBOOK(infobar_tabs), stats_tab, NULL);
 
     gtk_box_pack_start(GTK_BOX(infobar), infobar_toggles, FALSE, TRUE, 1);
     gtk_box_pack_start(GTK_BOX(infobar), infobar_tabs, TRUE, TRUE, 1);
 
+    g_signal_connect(infobar_tabs, "switch-page", G_CALLBACK(infobar_page_switched), NULL);
+    g_signal_connect(infobar, "map", G_CALLBACK(infobar_mapped), NULL);
+    g_signal_connect(infobar, "unmap", G_CALLBACK(infobar_unmapped), NULL);
+
     gtk_widget_show_all(infobar);
 }
 
-/* Disposes pixbuf allocated for biography image. */
+/* Disposes pixbuf allocated for biography image and its scaled copy. */
 static void
 free_bio_pixbuf(void) {
 
@@ -403,6 +666,12 @@ free_bio_pixbuf(void) {
         g_object_unref(bio_pixbuf);
         bio_pixbuf = NULL;
     }
+    free_bio_surface();
+
+    if (rescale_timer) {
+        g_source_remove(rescale_timer);
+        rescale_timer = 0;
+    }
 }
 
 /* Callback function to initialize widget called during plug-in connect. */
@@ -413,102 +682,148 @@ void infobar_init(struct ddb_gtkui_widget_s *widget) {
 /* Callback function to destroy widget called during plug-in disconnect. */
 void infobar_destroy(struct ddb_gtkui_widget_s *widget) {
     free_bio_pixbuf();
+
+    free(lyr_shown);
+    free(bio_shown);
+    lyr_shown = bio_shown = NULL;
+
+    if (stats_timer) {
+        g_source_remove(stats_timer);
+        stats_timer = 0;
+    }
+}
+
+/* Returns the size of the artist's image area in device pixels. */
+void infobar_bio_image_size(int *width, int *height) {
+
+    *width = __atomic_load_n(&bio_image_width, __ATOMIC_RELAXED);
+    *height = __atomic_load_n(&bio_image_height, __ATOMIC_RELAXED);
+}
+
+/* Checks if the specified view is currently shown to the user. */
+gboolean infobar_view_visible(InfobarView view) {
+    return __atomic_load_n(&visible_view, __ATOMIC_RELAXED) == (int) view;
+}
+
+/* Checks if the text is already shown in the view. Otherwise the text
+ * is remembered as the shown one. Takes ownership of the text, which
+ * can be NULL, if it couldn't be formed. */
+static gboolean
+is_text_shown(char **shown, char *txt) {
+
+    if (txt && *shown && strcmp(*shown, txt) == 0) {
+        free(txt);
+        return TRUE;
+    }
+    free(*shown);
+    *shown = txt;
+    return FALSE;
+}
+
+/* Creates an empty buffer with the tags of the view's buffer. It's filled
+ * before it's shown, so the view lays out the new text just once. */
+static GtkTextBuffer *
+new_view_buffer(GtkWidget *view) {
+
+    GtkTextBuffer *buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(view));
+    return gtk_text_buffer_new(gtk_text_buffer_get_tag_table(buffer));
+}
+
+/* Shows the filled buffer in the view, replacing the previous one. */
+static void
+swap_view_buffer(GtkWidget *view, GtkTextBuffer **buffer, GtkTextBuffer *filled) {
+
+    gtk_text_view_set_buffer(GTK_TEXT_VIEW(view), filled);
+    g_object_unref(filled);
+    *buffer = filled;
 }
 
 /* Updates "Lyrics" tab with the new lyrics. */
-void update_lyrics_view(const char *lyr_txt, DB_playItem_t *track) {    
-    GtkTextIter begin = {0}, end = {0};
-    
-    gtk_text_buffer_get_iter_at_line (lyr_buffer, &begin, 0);
-    gtk_text_buffer_get_end_iter (lyr_buffer, &end);
-    gtk_text_buffer_delete (lyr_buffer, &begin, &end);
-    
-    char *artist = NULL, *title = NULL;
-    int info = get_artist_and_title_info(track, &artist, &title);
-
-    /* Setting "bold" style for the song title. */
-    const char *title_up = (info == 0) ? title : TITLE_UNKNOWN;
-    gtk_text_buffer_insert_with_tags_by_name(GTK_TEXT_BUFFER(lyr_buffer),
-            &begin, title_up, -1, "bold", "large", NULL);
-
-    gtk_text_buffer_insert(lyr_buffer, &begin, "\n", -1);
-
-    /* Setting "italic" style for the artist name. */
-    const char *artist_up = (info == 0) ? artist : ARTIST_UNKNOWN;
-    gtk_text_buffer_insert_with_tags_by_name(GTK_TEXT_BUFFER(lyr_buffer),
-            &begin, artist_up, -1, "italic", NULL);
+void update_lyrics_view(const char *lyr_txt, const char *artist, const char *title) {
 
+    const char *title_up = title ? title : TITLE_UNKNOWN;
+    const char *artist_up = artist ? artist : ARTIST_UNKNOWN;
     const char *lyr_up = lyr_txt ? lyr_txt : LYR_NOT_FOUND;
-    gtk_text_buffer_insert(lyr_buffer, &begin, "\n\n", -1);
-    gtk_text_buffer_insert(lyr_buffer, &begin, lyr_up, strlen(lyr_up));
 
-    if (info == 0) {
-        free(artist);
-        free(title);
+    /* Nothing is changed, if the same lyrics are shown again. */
+    char *txt = NULL;
+    if (asprintf(&txt, "%s\n%s\n\n%s", title_up, artist_up, lyr_up) == -1)
+        txt = NULL;
+
+    if (!is_text_shown(&lyr_shown, txt)) {
+        GtkTextBuffer *buffer = new_view_buffer(lyr_view);
+        GtkTextIter begin = {0};
+        gtk_text_buffer_get_start_iter(buffer, &begin);
+
+        /* Setting "bold" style for the song title. */
+        gtk_text_buffer_insert_with_tags_by_name(buffer,
+                &begin, title_up, -1, "bold", "large", NULL);
+
+        gtk_text_buffer_insert(buffer, &begin, "\n", -1);
+
+        /* Setting "italic" style for the artist name. */
+        gtk_text_buffer_insert_with_tags_by_name(buffer,
+                &begin, artist_up, -1, "italic", NULL);
+
+        gtk_text_buffer_insert(buffer, &begin, "\n\n", -1);
+        gtk_text_buffer_insert(buffer, &begin, lyr_up, strlen(lyr_up));
+
+        swap_view_buffer(lyr_view, &lyr_buffer, buffer);
     }
 }
 
 /* Updates "Biography" tab with the new artist's image and biography text. */
-void update_bio_view(const char *bio_txt, const char *img_file) {
+void update_bio_view(const char *bio_txt, GdkPixbuf *img) {
 
     /* Drawing artist's image. */
     if (bio_image) {
-        /* Previous image has to be disposed (if exists). */
-        free_bio_pixbuf();
+        /* The same artist's image is reused, so it isn't scaled again. */
+        if (img != bio_pixbuf) {
+            /* Previous image has to be disposed (if exists). */
+            free_bio_pixbuf();
+
+            if (img)
+                bio_pixbuf = g_object_ref(img);
 
-        if (img_file) {
-            bio_pixbuf = gdk_pixbuf_new_from_file(img_file, NULL);
+            gtk_widget_queue_draw(bio_image);
         }
-        gtk_widget_queue_draw(bio_image);
     }
 
-    /* Updating biography text. */
+    /* Updating biography text, unless the same one is shown. */
     if (bio_buffer) {
 
-        GtkTextIter begin = {0}, end = {0};
+        const char *txt = bio_txt ? bio_txt : "Biography not found.";
+        if (!is_text_shown(&bio_shown, strdup(txt))) {
 
-        gtk_text_buffer_get_iter_at_line (bio_buffer, &begin, 0);
-        gtk_text_buffer_get_end_iter (bio_buffer, &end);
-        gtk_text_buffer_delete (bio_buffer, &begin, &end);
+            GtkTextBuffer *buffer = new_view_buffer(bio_view);
+            GtkTextIter begin = {0};
+            gtk_text_buffer_get_start_iter(buffer, &begin);
+            gtk_text_buffer_insert(buffer, &begin, txt, strlen(txt));
 
-        const char *txt = bio_txt ? bio_txt : "Biography not found.";
-        gtk_text_buffer_insert(bio_buffer, &begin, txt, strlen(txt));
+            swap_view_buffer(bio_view, &bio_buffer, buffer);
+        }
     }
 }
 
 /* Updates "Similar" tab with the new list of similar artists. */
 void update_similar_view(SimilarInfo *similar, size_t size) {
 
-    GtkTreeModel *model = gtk_tree_view_get_model(GTK_TREE_VIEW(sim_list));
-    GtkListStore *store = GTK_LIST_STORE(model);
-    if (store) {
-        /* Removing previous list from model. */
-        gtk_list_store_clear(store);
-        GtkTreeIter it = {0};
-
-        if (similar) {
-            for (size_t i = 0; i < size; ++i) {
-                gtk_list_store_append(store, &it);
+    /* New list is filled, while it isn't attached to the view, so
+     * the view doesn't react to every inserted row. */
+    GtkListStore *store = new_sim_store();
 
-                if (similar[i].name) {
-                    gtk_list_store_set(store, &it, NAME, similar[i].name, -1);
-                }
-                if (similar[i].match) {
-                    /* Converting match value to percentage representation. */
-                    char perc[10] = {0};
-                    if (string_to_perc(similar[i].match, perc) != -1) {
-                        gtk_list_store_set(store, &it, MATCH, perc, -1);
-                    }
-                }
-                if (similar[i].url) {
-                    gtk_list_store_set(store, &it, URL, similar[i].url, -1);
-                }
-            }
-        } else {
-            gtk_list_store_append(store, &it);
-            gtk_list_store_set(store, &it, NAME, "Similar artists not found.", -1);
+    if (similar) {
+        for (size_t i = 0; i < size; ++i) {
+            const char *perc = similar[i].perc[0] ? similar[i].perc : NULL;
+            gtk_list_store_insert_with_values(store, NULL, -1, NAME, similar[i].name,
+                    MATCH, perc, URL, similar[i].url, -1);
         }
+    } else {
+        gtk_list_store_insert_with_values(store, NULL, -1, NAME, "Similar artists not found.", -1);
     }
+
+    gtk_tree_view_set_model(GTK_TREE_VIEW(sim_list), GTK_TREE_MODEL(store));
+    g_object_unref(store);
 }
 
 /* This function should be invoked, when some changes to the plug-in's
@@ -536,6 +851,12 @@ void infobar_config_changed(void) {
         set_tab_visible(sim_toggle, sim_tab, state);
     }
 
+    /* Showing/hiding "Stats" tab. */
+    state = deadbeef->conf_get_int(CONF_STATS_ENABLED, 0);
+    if (stats_toggle && stats_tab) {
+        set_tab_visible(stats_toggle, stats_tab, state);
+    }
+
     /* Updating lyrics alignment. */
     int type = get_align_type();
     gtk_text_view_set_justification(GTK_TEXT_VIEW(lyr_view), type);
@@ -29,6 +29,7 @@
 #include "infobar.h"
 #include "types.h"
 #include "utils.h"
+#include "image.h"
 
 /* Messages. */
 #define TITLE_UNKNOWN "Unknown title"
@@ -37,21 +38,42 @@
  
 /* Properties. */
 #define BIO_IMAGE_HEIGHT 220
+#define BIO_IMAGE_RESCALE_DELAY 150
+#define STATS_REFRESH_PERIOD 2
+
+/* Views, which show fetched content. */
+typedef enum {
+    VIEW_NONE = -1,
+    VIEW_LYRICS = 0,
+    VIEW_BIO = 1,
+    VIEW_SIMILAR = 2,
+    VIEWS_COUNT = 3,
+} InfobarView;
 
 /* Infobar widget. */
-GtkWidget *infobar;
+extern GtkWidget *infobar;
 
 /* Creates infobar with all available tabs. */
 void create_infobar(void);
 
+/* Checks if the specified view is currently shown to the user: its tab
+ * is selected and the infobar is mapped. Can be called from any thread. */
+gboolean infobar_view_visible(InfobarView view);
+
+/* Returns the size of the artist's image area in device pixels, or 0,
+ * if it wasn't allocated yet. Can be called from any thread. */
+void infobar_bio_image_size(int *width, int *height);
+
 /* Updates "Similar" tab with the new list of similar artists. */
 void update_similar_view(SimilarInfo *similar, size_t size);
 
-/* Updates "Biography" tab with the new artist's image and biography text. */
-void update_bio_view(const char *bio_txt, const char *img_file);
+/* Updates "Biography" tab with the new artist's image and biography text.
+ * The image should be already decoded and scaled by the worker. */
+void update_bio_view(const char *bio_txt, GdkPixbuf *img);
 
-/* Updates "Lyrics" tab with the new lyrics. */
-void update_lyrics_view(const char *lyr_txt, DB_playItem_t *track);
+/* Updates "Lyrics" tab with the new lyrics of the track with the specified
+ * artist and title. They are NULL, if the track's metadata is unknown. */
+void update_lyrics_view(const char *lyr_txt, const char *artist, const char *title);
 
 /* This function should be invoked, when some changes to the plug-in's
  * configuration were made. It updates infobar view according to the
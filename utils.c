@@ -158,15 +158,18 @@ int parse_common(const char *content, const char *exp, ContentType type, char **
 int init_doc_obj(const char *content, ContentType type, xmlDocPtr *doc) {
     
     size_t len = strlen(content);
+    uint64_t span = span_begin();
     
     switch(type) {
     case XML:
         *doc = xmlReadMemory(content, len, NULL, "utf-8", (XML_PARSE_RECOVER |
                    XML_PARSE_NONET | XML_PARSE_NOWARNING | XML_PARSE_NOERROR));
+        span_end(span, "xml", SPAN_PARSE);
         break;
     case HTML:
         *doc = htmlReadMemory(content, len, NULL, "utf-8", (HTML_PARSE_RECOVER |
                   HTML_PARSE_NONET | HTML_PARSE_NOWARNING | HTML_PARSE_NOERROR));
+        span_end(span, "html", SPAN_PARSE);
     }
     return *doc ? 0 : -1;
 }
@@ -178,7 +181,9 @@ int get_xpath_obj(const xmlDocPtr doc, const char *exp, xmlXPathObjectPtr *obj)
     if (!ctx)
         return -1;
     
+    uint64_t span = span_begin();
     *obj = xmlXPathEvalExpression((xmlChar*) exp, ctx);
+    span_end(span, "xpath", SPAN_PARSE);
     if (!*obj || (*obj)->nodesetval->nodeNr == 0) {
         xmlXPathFreeContext(ctx);
         return -1;
@@ -187,105 +192,337 @@ int get_xpath_obj(const xmlDocPtr doc, const char *exp, xmlXPathObjectPtr *obj)
     return 0;
 }
 
-/* Retrieves text data from the specified URL.*/
-int retrieve_txt_content(const char *url, char **content) {
-    
+/* Text content being received. */
+typedef struct {
+    char *data;
+    size_t len;
+} TxtContent;
+
+/* Image being received and saved. */
+typedef struct {
+    FILE *file;
+    ImgSink *sink;
+    size_t len;
+    int failed;
+} ImgContent;
+
+/* Appends received data to the text content. Content exceeding
+ * MAX_TXT_SIZE is dropped. */
+static void
+append_txt(const char *data, size_t size, void *ctx) {
+
+    TxtContent *txt = ctx;
+    if (size > MAX_TXT_SIZE - txt->len)
+        size = MAX_TXT_SIZE - txt->len;
+
+    memcpy(txt->data + txt->len, data, size);
+    txt->len += size;
+}
+
+/* Writes received data to the image file and passes it to the sink. */
+static void
+write_img(const char *data, size_t size, void *ctx) {
+
+    ImgContent *img = ctx;
+    img->len += size;
+    if (!img->failed && fwrite(data, 1, size, img->file) != size)
+        img->failed = 1;
+
+    if (img->sink)
+        img->sink->write(data, size, img->sink->ctx);
+}
+
+/* Fetches content through deadbeef's VFS. The stream is watched by the
+ * watchdog, which aborts it when the provider's deadline is missed.
+ * Response status isn't known to the VFS, so it's left unset. */
+static int
+fetch_vfs_content(const char *url, Provider prov, HttpWriter writer, void *ctx, HttpResult *res) {
+
+    uint64_t span = span_begin();
     DB_FILE *stream = deadbeef->fopen(url);
+    span_end(span, "open", SPAN_NET);
     if (!stream)
         return -1;
 
-    *content = calloc(MAX_TXT_SIZE + 1, sizeof(char));
-    if (!*content) {
-        deadbeef->fclose(stream);
-        return -1;
+    Watch watch = {0};
+    watchdog_add(&watch, stream, prov);
+
+    size_t len = 0, total = 0;
+    char buf[READ_CHUNK_SIZE];
+
+    /* Streams are read in chunks, so the first one ends the connect phase. */
+    span = span_begin();
+    while ((len = deadbeef->fread(buf, 1, sizeof(buf), stream)) > 0) {
+        /* Aborted streams may report an error as (size_t) -1. */
+        if (len > sizeof(buf))
+            break;
+
+        if (total == 0)
+            watchdog_connected(&watch);
+
+        total += len;
+        writer(buf, len, ctx);
     }
+    span_end(span, "read", SPAN_NET);
+
+    res->timed_out = watchdog_remove(&watch);
+    deadbeef->fclose(stream);
+    return res->timed_out ? -1 : 0;
+}
+
+/* Fetches content of the specified URL through the HTTP backend, if it's
+ * enabled, or deadbeef's VFS otherwise, passing it to the writer. Only
+ * the HTTP backend can make conditional requests. */
+static int
+fetch_content(const char *url, Provider prov, Validators *val, HttpWriter writer, void *ctx, HttpResult *res) {
+
+    if (!http_enabled())
+        return fetch_vfs_content(url, prov, writer, ctx, res);
+
+    uint64_t span = span_begin();
+    int ret = http_get(url, prov, val, writer, ctx, res);
+    span_end(span, "get", SPAN_NET);
+    return ret;
+}
+
+/* Checks if the failed request means, that the provider is unavailable:
+ * it wasn't reached, timed out or responded with a server error. Client
+ * errors, such as a missing page, are just misses. */
+static int
+is_provider_down(const HttpResult *res) {
+    return res->timed_out || res->status < 400 || res->status >= 500;
+}
+
+/* Retrieves text data from the specified URL.*/
+int retrieve_txt_content(const char *url, Provider prov, Validators *val, char **content) {
     
-    if (deadbeef->fread(*content, 1, MAX_TXT_SIZE, stream) <= 0) {
-        deadbeef->fclose(stream);
-        free(*content);
-        *content = NULL;
+    if (!breaker_allow(prov)) {
+        stats_rejected(prov);
+        return FETCH_REJECTED;
+    }
+
+    TxtContent txt = {0};
+    txt.data = calloc(MAX_TXT_SIZE + 1, sizeof(char));
+    if (!txt.data) {
+        breaker_failure(prov);
         return -1;
     }
-    deadbeef->fclose(stream);
+
+    HttpResult http = {0};
+    int res = fetch_content(url, prov, val, append_txt, &txt, &http);
+    if (res == 0 && val && val->not_modified) {
+        /* Nothing to parse, the cached content is still valid. */
+        breaker_success(prov);
+        free(txt.data);
+        return -1;
+    }
+
+    if (res == -1 || txt.len == 0) {
+        if (http.timed_out)
+            stats_timeout(prov);
+        else
+            stats_error(prov);
+
+        /* Provider, which responded without content, is still up. */
+        if (res == -1 && is_provider_down(&http))
+            breaker_failure(prov);
+        else
+            breaker_success(prov);
+
+        free(txt.data);
+        return -1;
+    }
+    stats_bytes(prov, txt.len);
+    breaker_success(prov);
+    *content = txt.data;
     return 0;
 }
 
 /* Retrieves image file from the specified URL and saves it locally. */
-int retrieve_img_content(const char *url, const char *img) {
+int retrieve_img_content(const char *url, Provider prov, const char *img, ImgSink *sink) {
     
-    DB_FILE *stream = deadbeef->fopen(url);
-    if (!stream)
-        return -1;
+    if (!breaker_allow(prov)) {
+        stats_rejected(prov);
+        return FETCH_REJECTED;
+    }
 
-    FILE *out_file = fopen(img, "wb+");
-    if (!out_file) {
-        deadbeef->fclose(stream);
+    ImgContent out = {0};
+    out.sink = sink;
+    out.file = fopen(img, "wb+");
+    if (!out.file) {
+        breaker_failure(prov);
         return -1;
     }
 
-    size_t len = 0;
-    char temp[4096] = {0};
+    HttpResult http = {0};
+    int res = fetch_content(url, prov, NULL, write_img, &out, &http);
+    fclose(out.file);
+    stats_bytes(prov, out.len);
 
-    while ((len = deadbeef->fread(temp, 1, sizeof(temp), stream)) > 0) {
-        if (fwrite(temp, 1, len, out_file) != len) {
-            deadbeef->fclose(stream);
-            fclose(out_file);
-            return -1;
-        }
+    if (res == -1) {
+        /* Partially downloaded image shouldn't be cached. */
+        remove(img);
+        if (http.timed_out)
+            stats_timeout(prov);
+        else
+            stats_error(prov);
+
+        if (is_provider_down(&http))
+            breaker_failure(prov);
+        else
+            breaker_success(prov);
+        return -1;
     }
-    deadbeef->fclose(stream);
-    fclose(out_file);
-    return 0;
+    breaker_success(prov);
+    return out.failed ? -1 : 0;
 }
 
 /* Loads content of the specified text file. */
 int load_txt_file(const char *file, char **content) {
     
+    uint64_t span = span_begin();
     FILE *in_file = fopen(file, "r");
-    if (!in_file) 
-        return -1;
-
-    if (fseek(in_file, 0, SEEK_END) != 0) {
-        fclose(in_file);
+    if (!in_file) {
+        span_end(span, "load", SPAN_DISK);
         return -1;
     }
+
+    int res = -1;
+    if (fseek(in_file, 0, SEEK_END) != 0)
+        goto out;
     
     size_t size = ftell(in_file);
     rewind(in_file);
 
     *content = calloc(size + 1, sizeof(char));
-    if (!*content) {
-        fclose(in_file);
-        return -1;
-    }
+    if (!*content)
+        goto out;
     
     if (fread(*content, 1, size, in_file) != size) {
-        fclose(in_file);
         free(*content);
         *content = NULL;
-        return -1;
+        goto out;
     }
+    res = 0;
+
+out:
     fclose(in_file);
-    return 0;
+    span_end(span, "load", SPAN_DISK);
+    return res;
 }
 
 /* Saves specified content to the text file. */
 int save_txt_file(const char *file, const char *content) {
     
+    uint64_t span = span_begin();
     FILE *out_file = fopen(file, "w+");
-    if (!out_file)
+    if (!out_file) {
+        span_end(span, "save", SPAN_DISK);
         return -1;
+    }
         
     size_t size = strlen(content);
     
-    if (fwrite(content, 1, size, out_file) <= 0) {
-        fclose(out_file);
+    int res = fwrite(content, 1, size, out_file) <= 0 ? -1 : 0;
+    fclose(out_file);
+    span_end(span, "save", SPAN_DISK);
+    return res;
+}
+
+/* Forms name of the file, which keeps validators of the cache file. */
+static int
+get_meta_file(const char *cache_file, char **meta_file) {
+    return asprintf(meta_file, "%s.meta", cache_file) == -1 ? -1 : 0;
+}
+
+/* Reads the next line of the validators file. Empty line means the
+ * validator wasn't received. */
+static char *
+read_meta_line(FILE *in) {
+
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t len = getline(&line, &size, in);
+    if (len > 0 && line[len - 1] == '\n')
+        line[--len] = '\0';
+
+    if (len <= 0) {
+        free(line);
+        return NULL;
+    }
+    return line;
+}
+
+/* Loads validators of the specified cache file. */
+int load_validators(const char *cache_file, Validators *val) {
+
+    char *meta_file = NULL;
+    if (get_meta_file(cache_file, &meta_file) == -1)
+        return -1;
+
+    FILE *in = fopen(meta_file, "r");
+    free(meta_file);
+    if (!in)
+        return -1;
+
+    int prov = 0;
+    if (fscanf(in, "%d\n", &prov) != 1 || prov < 0 || prov >= PROVIDERS_COUNT) {
+        fclose(in);
         return -1;
     }
-    fclose(out_file);
+    val->prov = prov;
+    val->url = read_meta_line(in);
+    val->etag = read_meta_line(in);
+    val->last_modified = read_meta_line(in);
+    val->not_modified = 0;
+    fclose(in);
+
+    if (!val->url || (!val->etag && !val->last_modified)) {
+        free_validators(val);
+        return -1;
+    }
+    return 0;
+}
+
+/* Saves validators of the specified cache file. If there are none,
+ * the previous ones are removed, as they don't match the new content. */
+int save_validators(const char *cache_file, const Validators *val) {
+
+    char *meta_file = NULL;
+    if (get_meta_file(cache_file, &meta_file) == -1)
+        return -1;
+
+    if (!val->url || (!val->etag && !val->last_modified)) {
+        remove(meta_file);
+        free(meta_file);
+        return 0;
+    }
+
+    FILE *out = fopen(meta_file, "w");
+    free(meta_file);
+    if (!out)
+        return -1;
+
+    fprintf(out, "%d\n%s\n%s\n%s\n", val->prov, val->url,
+            val->etag ? val->etag : "", val->last_modified ? val->last_modified : "");
+    fclose(out);
     return 0;
 }
 
+/* Frees validators. */
+void free_validators(Validators *val) {
+
+    free(val->url);
+    free(val->etag);
+    free(val->last_modified);
+    val->url = val->etag = val->last_modified = NULL;
+}
+
+/* Marks the cache file as fresh, without changing its content. */
+int touch_cache(const char *cache_file) {
+    return utime(cache_file, NULL) == 0 ? 0 : -1;
+}
+
 /* Executes external script and reads its output. */
 int execute_script(const char *cmd, char **out) {
     
@@ -327,10 +564,26 @@ int del_lyr_cache(const char *artist, const char *title) {
         free(txt_cache);
         return -1;
     }
+    Validators val = {0};
+    save_validators(txt_cache, &val);
     free(txt_cache);
     return 0;
 }
 
+/* Forms the path to the artist's image of the specified size. Extralarge
+ * image keeps the name it always had, so existing cache is still used. */
+static int
+form_img_path(const char *cache_path, const char *artist, ImgSize size, char **img_cache) {
+
+    int res = 0;
+    if (size == IMG_EXTRALARGE)
+        res = asprintf(img_cache, "%s/%s_img", cache_path, artist);
+    else
+        res = asprintf(img_cache, "%s/%s_img_%s", cache_path, artist, img_size_name(size));
+
+    return res == -1 ? -1 : 0;
+}
+
 /* Deletes biography cache for specified artist. */
 int del_bio_cache(const char *artist) {
     
@@ -349,22 +602,27 @@ int del_bio_cache(const char *artist) {
         free(txt_cache);
         return -1;
     }
+    Validators val = {0};
+    save_validators(txt_cache, &val);
     free(txt_cache);
             
-    char *img_cache = NULL;
-    if (asprintf(&img_cache, "%s/%s_img", cache_path, artist) == -1) {
-        free(cache_path);
-        return -1;
-    }
-    
-    if (remove(img_cache) != 0) {
-        free(cache_path);
+    /* Images of all sizes are removed, at least one should exist. */
+    int removed = 0;
+    for (int size = 0; size < IMG_SIZES_COUNT; ++size) {
+
+        char *img_cache = NULL;
+        if (form_img_path(cache_path, artist, size, &img_cache) == -1) {
+            free(cache_path);
+            return -1;
+        }
+        del_thumb_cache(img_cache);
+        if (remove(img_cache) == 0)
+            ++removed;
+
         free(img_cache);
-        return -1;
     }
     free(cache_path);
-    free(img_cache);
-    return 0;
+    return removed > 0 ? 0 : -1;
 }
 
 /* Creates lyrics cache file for the specified track. */
@@ -389,8 +647,31 @@ int create_lyr_cache(const char *artist, const char *title, char **txt_cache) {
     return 0;
 }
 
+/* Creates cache file for the lyrics providers ranking. It's kept
+ * in the lyrics cache directory. */
+int create_ranking_cache(char **file) {
+
+    char *cache_path = NULL;
+    if (get_cache_path(&cache_path, LYRICS) == -1)
+        return -1;
+
+    if (!is_exists(cache_path)) {
+        if (create_dir(cache_path, 0755) == -1) {
+            free(cache_path);
+            return -1;
+        }
+    }
+
+    if (asprintf(file, "%s/.ranking", cache_path) == -1) {
+        free(cache_path);
+        return -1;
+    }
+    free(cache_path);
+    return 0;
+}
+
 /* Creates biography cache files for the specified artist. */
-int create_bio_cache(const char *artist, char **txt_cache, char **img_cache) {
+int create_bio_cache(const char *artist, ImgSize size, char **txt_cache, char **img_cache) {
     
     char *cache_path = NULL;
     if (get_cache_path(&cache_path, BIO) == -1)
@@ -408,7 +689,7 @@ int create_bio_cache(const char *artist, char **txt_cache, char **img_cache) {
         return -1;
     }
     
-    if (asprintf(img_cache, "%s/%s_img", cache_path, artist) == -1) {
+    if (form_img_path(cache_path, artist, size, img_cache) == -1) {
         free(cache_path);
         free(*txt_cache);
         return -1;
@@ -417,6 +698,33 @@ int create_bio_cache(const char *artist, char **txt_cache, char **img_cache) {
     return 0;
 }
 
+/* Returns lastfm's name of the image size. */
+const char *img_size_name(ImgSize size) {
+
+    static const char *names[IMG_SIZES_COUNT] = {
+        "small", "medium", "large", "extralarge", "mega",
+    };
+    return names[size];
+}
+
+/* Forms the path to the thumbnail of artist's image, which fits into
+ * the square of the specified size. */
+int form_thumb_path(const char *img_cache, int size, char **thumb) {
+    return asprintf(thumb, "%s_%d", img_cache, size) == -1 ? -1 : 0;
+}
+
+/* Deletes all thumbnails of artist's image. */
+void del_thumb_cache(const char *img_cache) {
+
+    for (int size = THUMB_SIZE_STEP; size <= THUMB_MAX_SIZE; size += THUMB_SIZE_STEP) {
+        char *thumb = NULL;
+        if (form_thumb_path(img_cache, size, &thumb) == 0) {
+            remove(thumb);
+            free(thumb);
+        }
+    }
+}
+
 /* Checks if the specified cache file is old. */
 gboolean is_old_cache(const char *cache_file, CacheType type) {
     
@@ -516,7 +824,11 @@ int convert_to_utf8(const char *str, char **str_utf8) {
     if (!*str_utf8) 
         return -1;
     
-    if (deadbeef->junk_iconv(str, len, *str_utf8, len * 4, str_cs, "utf-8") < 0) {
+    uint64_t span = span_begin();
+    int res = deadbeef->junk_iconv(str, len, *str_utf8, len * 4, str_cs, "utf-8");
+    span_end(span, "iconv", SPAN_TEXT);
+
+    if (res < 0) {
         free(*str_utf8);
         return -1;
     }
@@ -644,83 +956,59 @@ int get_redirect_info(const char *str, char **artist, char **title) {
     return 0;
 }
 
-/* Retrieves infomation about current artist. */
-int get_artist_info(DB_playItem_t *track, char **artist) {
-    
+/* Metadata fields, which are copied to the snapshot. */
+static const char *meta_keys[] = {
+    "artist", "title", "album", "album artist", "musicbrainz_artistid", "musicbrainz_trackid",
+};
+#define META_FIELDS_COUNT (sizeof(meta_keys) / sizeof(meta_keys[0]))
+
+/* Takes the snapshot of the track's metadata. */
+TrackMeta *get_track_meta(DB_playItem_t *track) {
+
+    const char *values[META_FIELDS_COUNT] = {0};
+    size_t lens[META_FIELDS_COUNT] = {0};
+    size_t total = 0;
+
     deadbeef->pl_lock();
-    
-    const char *cur_artist = deadbeef->pl_find_meta(track, "artist");
-    if (!cur_artist) {
+
+    if (!deadbeef->pl_find_meta(track, "artist")) {
         deadbeef->pl_unlock();
-        return -1;
+        return NULL;
     }
-    size_t alen = strlen(cur_artist);
-    
-    *artist = calloc(alen + 1, sizeof(char));
-    if (!*artist) {
-        deadbeef->pl_unlock();
-        return -1;
+    for (size_t i = 0; i < META_FIELDS_COUNT; ++i) {
+        values[i] = deadbeef->pl_find_meta(track, meta_keys[i]);
+        lens[i] = values[i] ? strlen(values[i]) : 0;
+        total += lens[i] + 1;
     }
-    memcpy(*artist, cur_artist, alen + 1);
-    deadbeef->pl_unlock();
-    return 0;
-}
 
-/* Retrieves infomation about current artist and title */
-int get_artist_and_title_info(DB_playItem_t *track, char **artist, char **title) {
-    
-    if (get_artist_info(track, artist) == -1)
-        return -1;
-    
-    deadbeef->pl_lock();
-    
-    const char *cur_title = deadbeef->pl_find_meta(track, "title");
-    if (!cur_title) {
-        deadbeef->pl_unlock();
-        free(*artist);
-        return -1;
-    }
-    size_t tlen = strlen(cur_title);
-    
-    *title = calloc(tlen + 1, sizeof(char));
-    if (!*title) {
+    TrackMeta *meta = malloc(sizeof(TrackMeta) + total);
+    if (!meta) {
         deadbeef->pl_unlock();
-        free(*artist);
-        return -1;
+        return NULL;
     }
-    memcpy(*title, cur_title, tlen + 1);
-    deadbeef->pl_unlock();
-    return 0;
-}
+    const char **fields[META_FIELDS_COUNT] = {
+        &meta->artist, &meta->title, &meta->album,
+        &meta->album_artist, &meta->mb_artist_id, &meta->mb_track_id,
+    };
 
-/* Retrieves information about current artist, title and album. */
-int get_full_track_info(DB_playItem_t *track, char **artist, char **title, char **album) {
-    
-    if (get_artist_and_title_info(track, artist, title) == -1)
-        return -1;
-    
-    deadbeef->pl_lock();
+    /* Strings are packed right after the snapshot. */
+    char *str = (char*) (meta + 1);
+    for (size_t i = 0; i < META_FIELDS_COUNT; ++i) {
+        if (values[i])
+            memcpy(str, values[i], lens[i]);
 
-    /* Album info is optional. Leaving empty string
-       if there is no album info available. */
-    const char *cur_album = deadbeef->pl_find_meta(track, "album");
-    if (!cur_album) {
-        deadbeef->pl_unlock();
-        *album = calloc(1, sizeof(char));
-        return 0;
-    }
-    size_t alen = strlen(cur_album);
-    
-    *album = calloc(alen + 1, sizeof(char));
-    if (!*album) {
-        deadbeef->pl_unlock();
-        free(*artist);
-        free(*title);
-        return -1;
+        str[lens[i]] = '\0';
+        *fields[i] = str;
+        str += lens[i] + 1;
     }
-    memcpy(*album, cur_album, alen + 1);
+    meta->duration = deadbeef->pl_get_item_duration(track);
     deadbeef->pl_unlock();
-    return 0;
+
+    /* Title is required for lyrics, so it's NULL, if the track doesn't have it. */
+    if (!values[1])
+        meta->title = NULL;
+
+    return meta;
 }
 
 /*Converts string to persentage representation */
@@ -23,7 +23,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <gtk/gtk.h>
+#include <time.h>
+#include <utime.h>
 #include <sys/stat.h>
 #include <libxml/tree.h>
 #include <libxml/xpath.h>
@@ -31,13 +32,24 @@
 #include <libxml/HTMLparser.h>
 #include <deadbeef/deadbeef.h>
 
-#include "infobar.h"
+#include "core.h"
 #include "types.h"
+#include "breaker.h"
+#include "watchdog.h"
+#include "http.h"
 
 /* Defines maximum number of characters that can be retrieved. */
 #define MAX_TXT_SIZE 100000
+
+/* Size of the chunks network streams are read by. */
+#define READ_CHUNK_SIZE 4096
 #define SEP "\n**************\n"
 
+/* Thumbnails of artist's image are made for the sizes rounded up to
+ * THUMB_SIZE_STEP pixels. Larger images are decoded from the original. */
+#define THUMB_SIZE_STEP 64
+#define THUMB_MAX_SIZE 1024
+
 /* Checks if specified file or directory is exists. */
 gboolean is_exists(const char *obj);
 
@@ -53,11 +65,21 @@ gboolean is_track_changed(DB_playItem_t *track);
 /* Checks if the specified cache file is old. */
 gboolean is_old_cache(const char *cache_file, CacheType type);
 
-/* Retrieves text data from the specified URL. */
-int retrieve_txt_content(const char *url, char **content);
+/* Returned by the retrieve functions, if the request wasn't made, because
+ * the circuit breaker of the provider is open. */
+#define FETCH_REJECTED -2
 
-/* Retrieves image file from the specified URL and saves it locally. */
-int retrieve_img_content(const char *url, const char *img);
+/* Retrieves text data from the specified URL. Received bytes and
+ * failures are accounted to the specified provider. If validators of the
+ * cached content are specified, the request is conditional: when the
+ * content hasn't changed, -1 is returned and their not_modified flag is set.
+ * Returns FETCH_REJECTED if the provider's circuit breaker is open. */
+int retrieve_txt_content(const char *url, Provider prov, Validators *val, char **content);
+
+/* Retrieves image file from the specified URL and saves it locally.
+ * If the sink is specified, it receives the image as it's downloaded.
+ * Returns FETCH_REJECTED if the provider's circuit breaker is open. */
+int retrieve_img_content(const char *url, Provider prov, const char *img, ImgSink *sink);
 
 /* Executes external script and reads its output. */
 int execute_script(const char *cmd, char **out);
@@ -68,6 +90,18 @@ int load_txt_file(const char *file, char **content);
 /* Saves specified content to the text file. */
 int save_txt_file(const char *file, const char *content);
 
+/* Loads validators of the specified cache file. */
+int load_validators(const char *cache_file, Validators *val);
+
+/* Saves validators of the specified cache file. */
+int save_validators(const char *cache_file, const Validators *val);
+
+/* Frees validators. */
+void free_validators(Validators *val);
+
+/* Marks the cache file as fresh, without changing its content. */
+int touch_cache(const char *cache_file);
+
 /* Converts specified string encoding to UTF-8. */
 int convert_to_utf8(const char *str, char **str_utf8);
 
@@ -85,14 +119,10 @@ int replace_all(const char *str, const char *orig, const char *with, char **repl
  * and song title. */
 int get_redirect_info(const char *str, char **artist, char **title);
 
-/* Retrieves infomation about current artist. */
-int get_artist_info(DB_playItem_t *track, char **artist);
-
-/* Retrieves infomation about current artist and title */
-int get_artist_and_title_info(DB_playItem_t *track, char **artist, char **title);
-
-/* Retrieves information about current artist, title and album. */
-int get_full_track_info(DB_playItem_t *track, char **artist, char **title, char **album);
+/* Takes the snapshot of the track's metadata under a single playlist lock.
+ * Title is NULL and other fields are empty, if the track doesn't have them.
+ * Returns NULL, if the track has no artist. The snapshot is freed by free(). */
+TrackMeta *get_track_meta(DB_playItem_t *track);
 
 /* Deletes biography cache for specified artist. */
 int del_bio_cache(const char *artist);
@@ -103,8 +133,22 @@ int del_lyr_cache(const char *artist, const char *title);
 /* Creates lyrics cache file for the specified track. */
 int create_lyr_cache(const char *artist, const char *title, char **txt_cache);
 
-/* Creates biography cache files for the specified artist. */
-int create_bio_cache(const char *artist, char **txt_cache, char **img_cache);
+/* Creates cache file for the lyrics providers ranking. */
+int create_ranking_cache(char **file);
+
+/* Creates biography cache files for the specified artist. Image of each
+ * size is cached separately. */
+int create_bio_cache(const char *artist, ImgSize size, char **txt_cache, char **img_cache);
+
+/* Returns lastfm's name of the image size. */
+const char *img_size_name(ImgSize size);
+
+/* Forms the path to the thumbnail of artist's image, which fits into
+ * the square of the specified size. */
+int form_thumb_path(const char *img_cache, int size, char **thumb);
+
+/* Deletes all thumbnails of artist's image. */
+void del_thumb_cache(const char *img_cache);
 
 /* Encodes artist name. */
 int encode_artist(const char *artist, char **eartist, const char space);
@@ -0,0 +1,182 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <time.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include "watchdog.h"
+#include "core.h"
+
+static Watch *watches;
+static pthread_t thread;
+static int started;
+static int stopped;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond;
+
+/* Returns deadline in nanoseconds on the monotonic clock
+ * for the specified timeout in seconds or 0 if there is no timeout. */
+static uint64_t
+get_deadline(uint64_t now, int timeout) {
+    return timeout > 0 ? now + timeout * 1000000000ULL : 0;
+}
+
+/* Returns the nearest deadline of the watch or 0 if it has no deadlines. */
+static uint64_t
+next_deadline(const Watch *watch) {
+
+    uint64_t deadline = watch->read_deadline;
+    if (!watch->connected && watch->connect_deadline &&
+        (!deadline || watch->connect_deadline < deadline))
+    {
+        deadline = watch->connect_deadline;
+    }
+    return deadline;
+}
+
+/* Aborts expired streams and sleeps till the nearest deadline. */
+static void *
+watch_streams(void *ctx) {
+
+    pthread_mutex_lock(&mutex);
+    while (!stopped) {
+
+        uint64_t now = stats_now();
+        uint64_t nearest = 0;
+
+        for (Watch *watch = watches; watch; watch = watch->next) {
+            uint64_t deadline = next_deadline(watch);
+            if (!deadline || watch->expired)
+                continue;
+
+            if (deadline <= now) {
+                trace("infobar: aborting stream after deadline\n");
+                watch->expired = 1;
+                deadbeef->fabort(watch->stream);
+            } else if (!nearest || deadline < nearest) {
+                nearest = deadline;
+            }
+        }
+
+        if (nearest) {
+            struct timespec ts = {0};
+            ts.tv_sec = nearest / 1000000000ULL;
+            ts.tv_nsec = nearest % 1000000000ULL;
+            pthread_cond_timedwait(&cond, &mutex, &ts);
+        } else {
+            pthread_cond_wait(&cond, &mutex);
+        }
+    }
+    pthread_mutex_unlock(&mutex);
+    return NULL;
+}
+
+/* Starts the watchdog thread. Should be called with the mutex held. */
+static int
+start_watchdog(void) {
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    stopped = 0;
+    if (pthread_create(&thread, NULL, watch_streams, NULL) != 0) {
+        pthread_cond_destroy(&cond);
+        return -1;
+    }
+    started = 1;
+    return 0;
+}
+
+/* Starts watching the stream. */
+void watchdog_add(Watch *watch, DB_FILE *stream, Provider prov) {
+
+    char key[64] = {0};
+    const char *site = provider_site(prov);
+    uint64_t now = stats_now();
+
+    watch->stream = stream;
+    watch->connected = 0;
+    watch->expired = 0;
+
+    snprintf(key, sizeof(key), CONF_CONNECT_TIMEOUT, site);
+    watch->connect_deadline = get_deadline(now, deadbeef->conf_get_int(key, DEF_CONNECT_TIMEOUT));
+
+    snprintf(key, sizeof(key), CONF_READ_TIMEOUT, site);
+    watch->read_deadline = get_deadline(now, deadbeef->conf_get_int(key, DEF_READ_TIMEOUT));
+
+    pthread_mutex_lock(&mutex);
+    if (!started && start_watchdog() == -1) {
+        /* Can't enforce the deadlines, the stream is just read as is. */
+        watch->connect_deadline = watch->read_deadline = 0;
+    }
+    watch->next = watches;
+    watches = watch;
+    if (started)
+        pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mutex);
+}
+
+/* Notifies the watchdog, that the first bytes have arrived. The watchdog
+ * isn't woken up, it'll find out the later deadline itself. */
+void watchdog_connected(Watch *watch) {
+
+    pthread_mutex_lock(&mutex);
+    watch->connected = 1;
+    pthread_mutex_unlock(&mutex);
+}
+
+/* Stops watching the stream. */
+int watchdog_remove(Watch *watch) {
+
+    pthread_mutex_lock(&mutex);
+    for (Watch **it = &watches; *it; it = &(*it)->next) {
+        if (*it == watch) {
+            *it = watch->next;
+            break;
+        }
+    }
+    int expired = watch->expired;
+    pthread_mutex_unlock(&mutex);
+    return expired;
+}
+
+/* Stops the watchdog thread. */
+void watchdog_shutdown(void) {
+
+    pthread_mutex_lock(&mutex);
+    if (!started) {
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
+    stopped = 1;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mutex);
+
+    pthread_join(thread, NULL);
+
+    pthread_mutex_lock(&mutex);
+    pthread_cond_destroy(&cond);
+    started = 0;
+    pthread_mutex_unlock(&mutex);
+}
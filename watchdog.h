@@ -0,0 +1,58 @@
+/*
+    Infobar plugin for DeaDBeeF music player
+    Copyright (C) 2011-2012 Dmitriy Simbiriatin <dmitriy.simbiriatin@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef INFOBAR_WATCHDOG_HEADER
+#define INFOBAR_WATCHDOG_HEADER
+
+#include <stdint.h>
+#include <deadbeef/deadbeef.h>
+
+#include "types.h"
+
+/* Default deadlines in seconds. 0 means no deadline. */
+#define DEF_CONNECT_TIMEOUT 5
+#define DEF_READ_TIMEOUT 15
+
+/* Stream, which is aborted if it isn't finished in time. Watches are
+ * owned by the caller and usually live on its stack. */
+typedef struct Watch {
+    DB_FILE *stream;
+    uint64_t connect_deadline;
+    uint64_t read_deadline;
+    int connected;
+    int expired;
+    struct Watch *next;
+} Watch;
+
+/* Starts watching the stream, opened to fetch content from the specified
+ * provider. Stream is aborted if the first bytes don't arrive before the
+ * provider's connect deadline, or the whole content isn't read before
+ * its read deadline. */
+void watchdog_add(Watch *watch, DB_FILE *stream, Provider prov);
+
+/* Notifies the watchdog, that the first bytes have arrived. */
+void watchdog_connected(Watch *watch);
+
+/* Stops watching the stream. Returns 1 if it was aborted. */
+int watchdog_remove(Watch *watch);
+
+/* Stops the watchdog thread. It's started again, if needed. */
+void watchdog_shutdown(void);
+
+#endif